@@ -0,0 +1,309 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Capture file implementation.
+ */
+
+#include "chttp-capture.h"
+#include <string.h>
+#if defined(_WIN32)
+#   include <windows.h>
+#else
+#   include <fcntl.h>
+#   include <sys/mman.h>
+#   include <sys/stat.h>
+#   include <unistd.h>
+#endif
+
+static const char _signature[8] = {
+    'C', 'H', 'T', 'T', 'P', 'C', 'A', 'P',
+};
+
+int http_capture_open (http_capture * self, const char * path)
+{
+    char signature[sizeof(_signature)];
+    long size = 0;
+    int valid = 0;
+    self->file = fopen(path, "a+b");
+    if (self->file == 0) {
+        return 0;
+    }
+    // Start new files with the signature, and check it in existing ones.
+    if ((fseek(self->file, 0, SEEK_END) == 0) &&
+        ((size = ftell(self->file)) >= 0))
+    {
+        if (size == 0) {
+            valid = (fwrite(_signature, sizeof(_signature), 1,
+                            self->file) == 1);
+        }
+        else {
+            rewind(self->file);
+            valid = (fread(signature, sizeof(signature), 1,
+                           self->file) == 1) &&
+                (memcmp(signature, _signature, sizeof(_signature)) == 0) &&
+                (fseek(self->file, 0, SEEK_END) == 0);
+        }
+    }
+    if (!valid) {
+        fclose(self->file), self->file = 0;
+    }
+    return (valid);
+}
+
+int http_capture_push (http_capture * self, const http_head * head)
+{
+    static const char null = '\0';
+    unsigned char prefix[4];
+    http_cursor cursor;
+    size_t size = 1;
+    http_cursor_init(&cursor, head);
+    while (http_cursor_next(&cursor)) {
+        size += cursor.field_size + cursor.value_size + 2;
+    }
+    if (size > 0xffffffffu) {
+        return 0;
+    }
+    prefix[0] = (unsigned char)(size >>  0);
+    prefix[1] = (unsigned char)(size >>  8);
+    prefix[2] = (unsigned char)(size >> 16);
+    prefix[3] = (unsigned char)(size >> 24);
+    if (fwrite(prefix, sizeof(prefix), 1, self->file) != 1) {
+        return 0;
+    }
+    // Names and data are null-terminated, so copy that too.  Tokens expose
+    // their canonical names, which are string literals.
+    http_cursor_init(&cursor, head);
+    while (http_cursor_next(&cursor))
+    {
+        if ((fwrite(cursor.field, cursor.field_size+1, 1, self->file) != 1) ||
+            (fwrite(cursor.value, cursor.value_size+1, 1, self->file) != 1)) {
+            return 0;
+        }
+    }
+    return (fwrite(&null, 1, 1, self->file) == 1);
+}
+
+int http_capture_close (http_capture * self)
+{
+    const int status = (fclose(self->file) == 0);
+    self->file = 0;
+    return (status);
+}
+
+// Mapped records are never modified, so heads can't grow either.
+static void * _mapped_acquire (void * context, size_t size)
+{
+    return (0);
+}
+
+static void * _mapped_resize (void * context, void * data,
+                              size_t used, size_t size)
+{
+    return (0);
+}
+
+static void _mapped_release (void * context, void * data, size_t size)
+{
+}
+
+static const http_allocator _mapped_allocator = {
+    _mapped_acquire, _mapped_resize, _mapped_release, 0,
+};
+
+#if defined(_WIN32)
+static int _map (http_replay * self, const char * path)
+{
+    LARGE_INTEGER size;
+    HANDLE mapping = 0;
+    const void * data = 0;
+    const HANDLE file = CreateFileA(path, GENERIC_READ, FILE_SHARE_READ, 0,
+        OPEN_EXISTING, FILE_FLAG_SEQUENTIAL_SCAN, 0);
+    if (file == INVALID_HANDLE_VALUE) {
+        return 0;
+    }
+    if (!GetFileSizeEx(file, &size) || (size.QuadPart == 0) ||
+        ((ULONGLONG)size.QuadPart > (size_t)-1)) {
+        CloseHandle(file);
+        return 0;
+    }
+    mapping = CreateFileMappingA(file, 0, PAGE_READONLY, 0, 0, 0);
+    CloseHandle(file);
+    if (mapping == 0) {
+        return 0;
+    }
+    data = MapViewOfFile(mapping, FILE_MAP_READ, 0, 0, 0);
+    if (data == 0) {
+        CloseHandle(mapping);
+        return 0;
+    }
+    self->data = data;
+    self->size = (size_t)size.QuadPart;
+    self->handle = mapping;
+    return 1;
+}
+
+static void _unmap (http_replay * self)
+{
+    UnmapViewOfFile(self->data);
+    CloseHandle(self->handle);
+}
+#else
+static int _map (http_replay * self, const char * path)
+{
+    struct stat status;
+    void * data = 0;
+    const int file = open(path, O_RDONLY);
+    if (file < 0) {
+        return 0;
+    }
+    // Empty files can't be mapped, and aren't valid anyways.
+    if ((fstat(file, &status) != 0) || (status.st_size <= 0)) {
+        close(file);
+        return 0;
+    }
+    data = mmap(0, (size_t)status.st_size, PROT_READ, MAP_PRIVATE, file, 0);
+    close(file);
+    if (data == MAP_FAILED) {
+        return 0;
+    }
+    // Records are read front to back.
+    posix_madvise(data, (size_t)status.st_size, POSIX_MADV_SEQUENTIAL);
+    self->data = data;
+    self->size = (size_t)status.st_size;
+    return 1;
+}
+
+static void _unmap (http_replay * self)
+{
+    munmap((void*)self->data, self->size);
+}
+#endif
+
+int http_replay_open (http_replay * self, const char * path)
+{
+    memset(self, 0, sizeof(http_replay));
+    if (!_map(self, path)) {
+        return 0;
+    }
+    if ((self->size < sizeof(_signature)) ||
+        (memcmp(self->data, _signature, sizeof(_signature)) != 0)) {
+        http_replay_close(self);
+        return 0;
+    }
+    http_replay_rewind(self);
+    return 1;
+}
+
+// Check that a record holds pairs of null-terminated strings, then a null.
+static int _check (const char * data, size_t size)
+{
+    const char * stop = data + size - 1;
+    const char * null = 0;
+    if (*stop != '\0') {
+        return 0;
+    }
+    while (data < stop)
+    {
+        // Control characters mark tokens and removed headers.
+        if ((unsigned char)*data < 0x20) {
+            return 0;
+        }
+        null = memchr(data, '\0', (size_t)(stop - data));
+        if (null == 0) {
+            return 0;
+        }
+        null = memchr(null+1, '\0', (size_t)(stop - null - 1));
+        if (null == 0) {
+            return 0;
+        }
+        data = null + 1;
+    }
+    return 1;
+}
+
+int http_replay_next (http_replay * self)
+{
+    const unsigned char * prefix = 0;
+    const char * data = 0;
+    size_t size = 0;
+    if (self->fail || (self->used == self->size)) {
+        return 0;
+    }
+    if ((self->size - self->used) < 4) {
+        self->fail = 1;
+        return 0;
+    }
+    prefix = (const unsigned char*)self->data + self->used;
+    size = (size_t)prefix[0] | ((size_t)prefix[1] << 8) |
+        ((size_t)prefix[2] << 16) | ((size_t)prefix[3] << 24);
+    data = self->data + self->used + 4;
+    if ((size == 0) || (size > (self->size - self->used - 4)) ||
+        !_check(data, size)) {
+        self->fail = 1;
+        return 0;
+    }
+    self->used += 4 + size;
+    // The mapping is read-only, but heads are only handed out as const.
+    self->head.data = (char*)data;
+    self->head.size = self->head.limit = size;
+    self->head.used = size - 1;
+    return 1;
+}
+
+const http_head * http_replay_head (const http_replay * self)
+{
+    return (&self->head);
+}
+
+void http_replay_rewind (http_replay * self)
+{
+    static char empty[1] = { '\0' };
+    self->used = sizeof(_signature);
+    self->fail = 0;
+    self->head.data = empty;
+    self->head.size = self->head.limit = 1;
+    self->head.used = self->head.dead = 0;
+    self->head.index = 0;
+    self->head.cache = 0;
+    self->head.storage = 0;
+    self->head.allocator = &_mapped_allocator;
+    self->head.options = 0;
+}
+
+int http_replay_fail (const http_replay * self)
+{
+    return (self->fail);
+}
+
+void http_replay_close (http_replay * self)
+{
+    if (self->data != 0) {
+        _unmap(self);
+    }
+    memset(self, 0, sizeof(http_replay));
+}
@@ -0,0 +1,220 @@
+#ifndef _chttp_capture_h__
+#define _chttp_capture_h__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Binary capture files for replaying HTTP headers.
+ *
+ * A capture file starts with the 8 byte signature @c "CHTTPCAP", followed by
+ * one record per captured @c http_head.  Each record is a 4 byte length, in
+ * little-endian byte order, then that many bytes laid out like the buffer of
+ * an @c http_head: alternating null-terminated names and data, then a final
+ * null character.  Removed headers are left out and tokens are written as
+ * the names they stand for, so files don't depend on the options used to
+ * capture them.
+ *
+ * Since records need no decoding, replay maps the file in memory and points
+ * read-only @c http_head objects straight at each record.
+ */
+
+#include "chttp.h"
+#include <stdio.h>
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @brief Writer that appends records to a capture file.
+ */
+typedef struct http_capture
+{
+    /*!
+     * @private
+     * @brief File opened for appending.
+     */
+    FILE * file;
+
+} http_capture;
+
+/*!
+ * @brief Open a capture file for appending, creating it if necessary.
+ * @param self
+ * @param path Name of the file.
+ * @return 0 if the file can't be opened or isn't a capture file, else
+ *  non-zero.
+ *
+ * @memberof http_capture
+ */
+int http_capture_open (http_capture * self, const char * path);
+
+/*!
+ * @brief Append a record for the HTTP headers in @a head.
+ * @param self
+ * @param head Headers to capture.
+ * @return 0 on error, else non-zero.
+ *
+ * Writes are buffered: the record may not be in the file until @c
+ * http_capture_close returns.
+ *
+ * @memberof http_capture
+ */
+int http_capture_push (http_capture * self, const http_head * head);
+
+/*!
+ * @brief Flush and close the file.
+ * @param self
+ * @return 0 if buffered records could not be written, else non-zero.
+ *
+ * @memberof http_capture
+ */
+int http_capture_close (http_capture * self);
+
+/*!
+ * @brief Reader that maps a capture file in memory.
+ *
+ * @code
+ *  http_replay replay;
+ *  if (!http_replay_open(&replay, "requests.cap")) {
+ *      // ...
+ *  }
+ *  while (http_replay_next(&replay)) {
+ *      handle(http_replay_head(&replay));
+ *  }
+ *  if (http_replay_fail(&replay)) {
+ *      // ...
+ *  }
+ *  http_replay_close(&replay);
+ * @endcode
+ */
+typedef struct http_replay
+{
+    /*!
+     * @private
+     * @brief Mapped file contents.
+     */
+    const char * data;
+
+    /*!
+     * @private
+     * @brief Size of the file, in bytes.
+     */
+    size_t size;
+
+    /*!
+     * @private
+     * @brief Offset of the next record.
+     */
+    size_t used;
+
+    /*!
+     * @private
+     * @brief Non-zero once a malformed record has been found.
+     */
+    int fail;
+
+    /*!
+     * @private
+     * @brief Platform-specific mapping handle.
+     */
+    void * handle;
+
+    /*!
+     * @private
+     * @brief Read-only view of the current record.
+     */
+    http_head head;
+
+} http_replay;
+
+/*!
+ * @brief Map a capture file in memory.
+ * @param self
+ * @param path Name of the file.
+ * @return 0 if the file can't be mapped or isn't a capture file, else
+ *  non-zero.
+ *
+ * @memberof http_replay
+ */
+int http_replay_open (http_replay * self, const char * path);
+
+/*!
+ * @brief Move to the next record.
+ * @param self
+ * @return 0 after the last record or when a record is malformed, else
+ *  non-zero.
+ *
+ * Records are checked before being exposed, since a damaged file could
+ * otherwise make cursors read past the mapping.
+ *
+ * @memberof http_replay
+ * @see http_replay_fail
+ */
+int http_replay_next (http_replay * self);
+
+/*!
+ * @brief Access the HTTP headers in the current record.
+ * @param self
+ * @return Headers that remain valid until the next call to @c
+ *  http_replay_next, @c http_replay_rewind or @c http_replay_close.  They
+ *  live in read-only memory and must never be modified.
+ *
+ * @memberof http_replay
+ */
+const http_head * http_replay_head (const http_replay * self);
+
+/*!
+ * @brief Start over from the first record.
+ * @param self
+ *
+ * @memberof http_replay
+ */
+void http_replay_rewind (http_replay * self);
+
+/*!
+ * @brief Check if replay stopped on a malformed record.
+ * @param self
+ *
+ * @memberof http_replay
+ */
+int http_replay_fail (const http_replay * self);
+
+/*!
+ * @brief Unmap the file.
+ * @param self
+ *
+ * @memberof http_replay
+ */
+void http_replay_close (http_replay * self);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _chttp_capture_h__ */
@@ -0,0 +1,938 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file
+ * @brief HPACK implementation.
+ */
+
+#include "chttp-hpack.h"
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct http_hpack_static
+{
+    const char * field;
+    size_t field_size;
+    const char * value;
+    size_t value_size;
+} http_hpack_static;
+
+#define HPACK_STATIC(field, value) \
+    { field, sizeof(field)-1, value, sizeof(value)-1 }
+
+// RFC 7541, appendix A.  Entry N is at index N-1.
+static const http_hpack_static _static[61] = {
+    HPACK_STATIC(":authority", ""),
+    HPACK_STATIC(":method", "GET"),
+    HPACK_STATIC(":method", "POST"),
+    HPACK_STATIC(":path", "/"),
+    HPACK_STATIC(":path", "/index.html"),
+    HPACK_STATIC(":scheme", "http"),
+    HPACK_STATIC(":scheme", "https"),
+    HPACK_STATIC(":status", "200"),
+    HPACK_STATIC(":status", "204"),
+    HPACK_STATIC(":status", "206"),
+    HPACK_STATIC(":status", "304"),
+    HPACK_STATIC(":status", "400"),
+    HPACK_STATIC(":status", "404"),
+    HPACK_STATIC(":status", "500"),
+    HPACK_STATIC("accept-charset", ""),
+    HPACK_STATIC("accept-encoding", "gzip, deflate"),
+    HPACK_STATIC("accept-language", ""),
+    HPACK_STATIC("accept-ranges", ""),
+    HPACK_STATIC("accept", ""),
+    HPACK_STATIC("access-control-allow-origin", ""),
+    HPACK_STATIC("age", ""),
+    HPACK_STATIC("allow", ""),
+    HPACK_STATIC("authorization", ""),
+    HPACK_STATIC("cache-control", ""),
+    HPACK_STATIC("content-disposition", ""),
+    HPACK_STATIC("content-encoding", ""),
+    HPACK_STATIC("content-language", ""),
+    HPACK_STATIC("content-length", ""),
+    HPACK_STATIC("content-location", ""),
+    HPACK_STATIC("content-range", ""),
+    HPACK_STATIC("content-type", ""),
+    HPACK_STATIC("cookie", ""),
+    HPACK_STATIC("date", ""),
+    HPACK_STATIC("etag", ""),
+    HPACK_STATIC("expect", ""),
+    HPACK_STATIC("expires", ""),
+    HPACK_STATIC("from", ""),
+    HPACK_STATIC("host", ""),
+    HPACK_STATIC("if-match", ""),
+    HPACK_STATIC("if-modified-since", ""),
+    HPACK_STATIC("if-none-match", ""),
+    HPACK_STATIC("if-range", ""),
+    HPACK_STATIC("if-unmodified-since", ""),
+    HPACK_STATIC("last-modified", ""),
+    HPACK_STATIC("link", ""),
+    HPACK_STATIC("location", ""),
+    HPACK_STATIC("max-forwards", ""),
+    HPACK_STATIC("proxy-authenticate", ""),
+    HPACK_STATIC("proxy-authorization", ""),
+    HPACK_STATIC("range", ""),
+    HPACK_STATIC("referer", ""),
+    HPACK_STATIC("refresh", ""),
+    HPACK_STATIC("retry-after", ""),
+    HPACK_STATIC("server", ""),
+    HPACK_STATIC("set-cookie", ""),
+    HPACK_STATIC("strict-transport-security", ""),
+    HPACK_STATIC("transfer-encoding", ""),
+    HPACK_STATIC("user-agent", ""),
+    HPACK_STATIC("vary", ""),
+    HPACK_STATIC("via", ""),
+    HPACK_STATIC("www-authenticate", ""),
+};
+
+// Indices 1-61 refer to the static table, the dynamic table follows.
+#define HPACK_DYNAMIC 62
+
+/*
+ * Huffman code from RFC 7541, appendix B.  The code is canonical: codes of
+ * the same length are consecutive integers, and they are numbered in order
+ * of increasing length.  Symbol 256 is EOS.
+ */
+typedef struct http_huffman_code
+{
+    unsigned long code;
+    int bits;
+} http_huffman_code;
+
+// Decodes codes of up to 8 bits using the next 8 bits of input (bits is 0
+// for longer codes).
+typedef struct http_huffman_fast
+{
+    unsigned short symbol;
+    unsigned char bits;
+} http_huffman_fast;
+
+// For each code length: 1 + the last code of that length, left-aligned on 32
+// bits, the first code of that length and the position of its symbol in the
+// symbols sorted by code.
+typedef struct http_huffman_length
+{
+    unsigned long limit;
+    unsigned long first;
+    unsigned short offset;
+} http_huffman_length;
+
+static const http_huffman_code _codes[257] = {
+    { 0x00001ff8, 13 }, { 0x007fffd8, 23 }, { 0x0fffffe2, 28 }, { 0x0fffffe3, 28 },
+    { 0x0fffffe4, 28 }, { 0x0fffffe5, 28 }, { 0x0fffffe6, 28 }, { 0x0fffffe7, 28 },
+    { 0x0fffffe8, 28 }, { 0x00ffffea, 24 }, { 0x3ffffffc, 30 }, { 0x0fffffe9, 28 },
+    { 0x0fffffea, 28 }, { 0x3ffffffd, 30 }, { 0x0fffffeb, 28 }, { 0x0fffffec, 28 },
+    { 0x0fffffed, 28 }, { 0x0fffffee, 28 }, { 0x0fffffef, 28 }, { 0x0ffffff0, 28 },
+    { 0x0ffffff1, 28 }, { 0x0ffffff2, 28 }, { 0x3ffffffe, 30 }, { 0x0ffffff3, 28 },
+    { 0x0ffffff4, 28 }, { 0x0ffffff5, 28 }, { 0x0ffffff6, 28 }, { 0x0ffffff7, 28 },
+    { 0x0ffffff8, 28 }, { 0x0ffffff9, 28 }, { 0x0ffffffa, 28 }, { 0x0ffffffb, 28 },
+    { 0x00000014,  6 }, { 0x000003f8, 10 }, { 0x000003f9, 10 }, { 0x00000ffa, 12 },
+    { 0x00001ff9, 13 }, { 0x00000015,  6 }, { 0x000000f8,  8 }, { 0x000007fa, 11 },
+    { 0x000003fa, 10 }, { 0x000003fb, 10 }, { 0x000000f9,  8 }, { 0x000007fb, 11 },
+    { 0x000000fa,  8 }, { 0x00000016,  6 }, { 0x00000017,  6 }, { 0x00000018,  6 },
+    { 0x00000000,  5 }, { 0x00000001,  5 }, { 0x00000002,  5 }, { 0x00000019,  6 },
+    { 0x0000001a,  6 }, { 0x0000001b,  6 }, { 0x0000001c,  6 }, { 0x0000001d,  6 },
+    { 0x0000001e,  6 }, { 0x0000001f,  6 }, { 0x0000005c,  7 }, { 0x000000fb,  8 },
+    { 0x00007ffc, 15 }, { 0x00000020,  6 }, { 0x00000ffb, 12 }, { 0x000003fc, 10 },
+    { 0x00001ffa, 13 }, { 0x00000021,  6 }, { 0x0000005d,  7 }, { 0x0000005e,  7 },
+    { 0x0000005f,  7 }, { 0x00000060,  7 }, { 0x00000061,  7 }, { 0x00000062,  7 },
+    { 0x00000063,  7 }, { 0x00000064,  7 }, { 0x00000065,  7 }, { 0x00000066,  7 },
+    { 0x00000067,  7 }, { 0x00000068,  7 }, { 0x00000069,  7 }, { 0x0000006a,  7 },
+    { 0x0000006b,  7 }, { 0x0000006c,  7 }, { 0x0000006d,  7 }, { 0x0000006e,  7 },
+    { 0x0000006f,  7 }, { 0x00000070,  7 }, { 0x00000071,  7 }, { 0x00000072,  7 },
+    { 0x000000fc,  8 }, { 0x00000073,  7 }, { 0x000000fd,  8 }, { 0x00001ffb, 13 },
+    { 0x0007fff0, 19 }, { 0x00001ffc, 13 }, { 0x00003ffc, 14 }, { 0x00000022,  6 },
+    { 0x00007ffd, 15 }, { 0x00000003,  5 }, { 0x00000023,  6 }, { 0x00000004,  5 },
+    { 0x00000024,  6 }, { 0x00000005,  5 }, { 0x00000025,  6 }, { 0x00000026,  6 },
+    { 0x00000027,  6 }, { 0x00000006,  5 }, { 0x00000074,  7 }, { 0x00000075,  7 },
+    { 0x00000028,  6 }, { 0x00000029,  6 }, { 0x0000002a,  6 }, { 0x00000007,  5 },
+    { 0x0000002b,  6 }, { 0x00000076,  7 }, { 0x0000002c,  6 }, { 0x00000008,  5 },
+    { 0x00000009,  5 }, { 0x0000002d,  6 }, { 0x00000077,  7 }, { 0x00000078,  7 },
+    { 0x00000079,  7 }, { 0x0000007a,  7 }, { 0x0000007b,  7 }, { 0x00007ffe, 15 },
+    { 0x000007fc, 11 }, { 0x00003ffd, 14 }, { 0x00001ffd, 13 }, { 0x0ffffffc, 28 },
+    { 0x000fffe6, 20 }, { 0x003fffd2, 22 }, { 0x000fffe7, 20 }, { 0x000fffe8, 20 },
+    { 0x003fffd3, 22 }, { 0x003fffd4, 22 }, { 0x003fffd5, 22 }, { 0x007fffd9, 23 },
+    { 0x003fffd6, 22 }, { 0x007fffda, 23 }, { 0x007fffdb, 23 }, { 0x007fffdc, 23 },
+    { 0x007fffdd, 23 }, { 0x007fffde, 23 }, { 0x00ffffeb, 24 }, { 0x007fffdf, 23 },
+    { 0x00ffffec, 24 }, { 0x00ffffed, 24 }, { 0x003fffd7, 22 }, { 0x007fffe0, 23 },
+    { 0x00ffffee, 24 }, { 0x007fffe1, 23 }, { 0x007fffe2, 23 }, { 0x007fffe3, 23 },
+    { 0x007fffe4, 23 }, { 0x001fffdc, 21 }, { 0x003fffd8, 22 }, { 0x007fffe5, 23 },
+    { 0x003fffd9, 22 }, { 0x007fffe6, 23 }, { 0x007fffe7, 23 }, { 0x00ffffef, 24 },
+    { 0x003fffda, 22 }, { 0x001fffdd, 21 }, { 0x000fffe9, 20 }, { 0x003fffdb, 22 },
+    { 0x003fffdc, 22 }, { 0x007fffe8, 23 }, { 0x007fffe9, 23 }, { 0x001fffde, 21 },
+    { 0x007fffea, 23 }, { 0x003fffdd, 22 }, { 0x003fffde, 22 }, { 0x00fffff0, 24 },
+    { 0x001fffdf, 21 }, { 0x003fffdf, 22 }, { 0x007fffeb, 23 }, { 0x007fffec, 23 },
+    { 0x001fffe0, 21 }, { 0x001fffe1, 21 }, { 0x003fffe0, 22 }, { 0x001fffe2, 21 },
+    { 0x007fffed, 23 }, { 0x003fffe1, 22 }, { 0x007fffee, 23 }, { 0x007fffef, 23 },
+    { 0x000fffea, 20 }, { 0x003fffe2, 22 }, { 0x003fffe3, 22 }, { 0x003fffe4, 22 },
+    { 0x007ffff0, 23 }, { 0x003fffe5, 22 }, { 0x003fffe6, 22 }, { 0x007ffff1, 23 },
+    { 0x03ffffe0, 26 }, { 0x03ffffe1, 26 }, { 0x000fffeb, 20 }, { 0x0007fff1, 19 },
+    { 0x003fffe7, 22 }, { 0x007ffff2, 23 }, { 0x003fffe8, 22 }, { 0x01ffffec, 25 },
+    { 0x03ffffe2, 26 }, { 0x03ffffe3, 26 }, { 0x03ffffe4, 26 }, { 0x07ffffde, 27 },
+    { 0x07ffffdf, 27 }, { 0x03ffffe5, 26 }, { 0x00fffff1, 24 }, { 0x01ffffed, 25 },
+    { 0x0007fff2, 19 }, { 0x001fffe3, 21 }, { 0x03ffffe6, 26 }, { 0x07ffffe0, 27 },
+    { 0x07ffffe1, 27 }, { 0x03ffffe7, 26 }, { 0x07ffffe2, 27 }, { 0x00fffff2, 24 },
+    { 0x001fffe4, 21 }, { 0x001fffe5, 21 }, { 0x03ffffe8, 26 }, { 0x03ffffe9, 26 },
+    { 0x0ffffffd, 28 }, { 0x07ffffe3, 27 }, { 0x07ffffe4, 27 }, { 0x07ffffe5, 27 },
+    { 0x000fffec, 20 }, { 0x00fffff3, 24 }, { 0x000fffed, 20 }, { 0x001fffe6, 21 },
+    { 0x003fffe9, 22 }, { 0x001fffe7, 21 }, { 0x001fffe8, 21 }, { 0x007ffff3, 23 },
+    { 0x003fffea, 22 }, { 0x003fffeb, 22 }, { 0x01ffffee, 25 }, { 0x01ffffef, 25 },
+    { 0x00fffff4, 24 }, { 0x00fffff5, 24 }, { 0x03ffffea, 26 }, { 0x007ffff4, 23 },
+    { 0x03ffffeb, 26 }, { 0x07ffffe6, 27 }, { 0x03ffffec, 26 }, { 0x03ffffed, 26 },
+    { 0x07ffffe7, 27 }, { 0x07ffffe8, 27 }, { 0x07ffffe9, 27 }, { 0x07ffffea, 27 },
+    { 0x07ffffeb, 27 }, { 0x0ffffffe, 28 }, { 0x07ffffec, 27 }, { 0x07ffffed, 27 },
+    { 0x07ffffee, 27 }, { 0x07ffffef, 27 }, { 0x07fffff0, 27 }, { 0x03ffffee, 26 },
+    { 0x3fffffff, 30 },
+};
+
+static const http_huffman_fast _fast[256] = {
+    {  48, 5 }, {  48, 5 }, {  48, 5 }, {  48, 5 }, {  48, 5 }, {  48, 5 },
+    {  48, 5 }, {  48, 5 }, {  49, 5 }, {  49, 5 }, {  49, 5 }, {  49, 5 },
+    {  49, 5 }, {  49, 5 }, {  49, 5 }, {  49, 5 }, {  50, 5 }, {  50, 5 },
+    {  50, 5 }, {  50, 5 }, {  50, 5 }, {  50, 5 }, {  50, 5 }, {  50, 5 },
+    {  97, 5 }, {  97, 5 }, {  97, 5 }, {  97, 5 }, {  97, 5 }, {  97, 5 },
+    {  97, 5 }, {  97, 5 }, {  99, 5 }, {  99, 5 }, {  99, 5 }, {  99, 5 },
+    {  99, 5 }, {  99, 5 }, {  99, 5 }, {  99, 5 }, { 101, 5 }, { 101, 5 },
+    { 101, 5 }, { 101, 5 }, { 101, 5 }, { 101, 5 }, { 101, 5 }, { 101, 5 },
+    { 105, 5 }, { 105, 5 }, { 105, 5 }, { 105, 5 }, { 105, 5 }, { 105, 5 },
+    { 105, 5 }, { 105, 5 }, { 111, 5 }, { 111, 5 }, { 111, 5 }, { 111, 5 },
+    { 111, 5 }, { 111, 5 }, { 111, 5 }, { 111, 5 }, { 115, 5 }, { 115, 5 },
+    { 115, 5 }, { 115, 5 }, { 115, 5 }, { 115, 5 }, { 115, 5 }, { 115, 5 },
+    { 116, 5 }, { 116, 5 }, { 116, 5 }, { 116, 5 }, { 116, 5 }, { 116, 5 },
+    { 116, 5 }, { 116, 5 }, {  32, 6 }, {  32, 6 }, {  32, 6 }, {  32, 6 },
+    {  37, 6 }, {  37, 6 }, {  37, 6 }, {  37, 6 }, {  45, 6 }, {  45, 6 },
+    {  45, 6 }, {  45, 6 }, {  46, 6 }, {  46, 6 }, {  46, 6 }, {  46, 6 },
+    {  47, 6 }, {  47, 6 }, {  47, 6 }, {  47, 6 }, {  51, 6 }, {  51, 6 },
+    {  51, 6 }, {  51, 6 }, {  52, 6 }, {  52, 6 }, {  52, 6 }, {  52, 6 },
+    {  53, 6 }, {  53, 6 }, {  53, 6 }, {  53, 6 }, {  54, 6 }, {  54, 6 },
+    {  54, 6 }, {  54, 6 }, {  55, 6 }, {  55, 6 }, {  55, 6 }, {  55, 6 },
+    {  56, 6 }, {  56, 6 }, {  56, 6 }, {  56, 6 }, {  57, 6 }, {  57, 6 },
+    {  57, 6 }, {  57, 6 }, {  61, 6 }, {  61, 6 }, {  61, 6 }, {  61, 6 },
+    {  65, 6 }, {  65, 6 }, {  65, 6 }, {  65, 6 }, {  95, 6 }, {  95, 6 },
+    {  95, 6 }, {  95, 6 }, {  98, 6 }, {  98, 6 }, {  98, 6 }, {  98, 6 },
+    { 100, 6 }, { 100, 6 }, { 100, 6 }, { 100, 6 }, { 102, 6 }, { 102, 6 },
+    { 102, 6 }, { 102, 6 }, { 103, 6 }, { 103, 6 }, { 103, 6 }, { 103, 6 },
+    { 104, 6 }, { 104, 6 }, { 104, 6 }, { 104, 6 }, { 108, 6 }, { 108, 6 },
+    { 108, 6 }, { 108, 6 }, { 109, 6 }, { 109, 6 }, { 109, 6 }, { 109, 6 },
+    { 110, 6 }, { 110, 6 }, { 110, 6 }, { 110, 6 }, { 112, 6 }, { 112, 6 },
+    { 112, 6 }, { 112, 6 }, { 114, 6 }, { 114, 6 }, { 114, 6 }, { 114, 6 },
+    { 117, 6 }, { 117, 6 }, { 117, 6 }, { 117, 6 }, {  58, 7 }, {  58, 7 },
+    {  66, 7 }, {  66, 7 }, {  67, 7 }, {  67, 7 }, {  68, 7 }, {  68, 7 },
+    {  69, 7 }, {  69, 7 }, {  70, 7 }, {  70, 7 }, {  71, 7 }, {  71, 7 },
+    {  72, 7 }, {  72, 7 }, {  73, 7 }, {  73, 7 }, {  74, 7 }, {  74, 7 },
+    {  75, 7 }, {  75, 7 }, {  76, 7 }, {  76, 7 }, {  77, 7 }, {  77, 7 },
+    {  78, 7 }, {  78, 7 }, {  79, 7 }, {  79, 7 }, {  80, 7 }, {  80, 7 },
+    {  81, 7 }, {  81, 7 }, {  82, 7 }, {  82, 7 }, {  83, 7 }, {  83, 7 },
+    {  84, 7 }, {  84, 7 }, {  85, 7 }, {  85, 7 }, {  86, 7 }, {  86, 7 },
+    {  87, 7 }, {  87, 7 }, {  89, 7 }, {  89, 7 }, { 106, 7 }, { 106, 7 },
+    { 107, 7 }, { 107, 7 }, { 113, 7 }, { 113, 7 }, { 118, 7 }, { 118, 7 },
+    { 119, 7 }, { 119, 7 }, { 120, 7 }, { 120, 7 }, { 121, 7 }, { 121, 7 },
+    { 122, 7 }, { 122, 7 }, {  38, 8 }, {  42, 8 }, {  44, 8 }, {  59, 8 },
+    {  88, 8 }, {  90, 8 }, {   0, 0 }, {   0, 0 },
+};
+
+static const http_huffman_length _lengths[31] = {
+    { 0x00000000ul, 0x00000000ul,   0 }, /*  0 */
+    { 0x00000000ul, 0x00000000ul,   0 }, /*  1 */
+    { 0x00000000ul, 0x00000000ul,   0 }, /*  2 */
+    { 0x00000000ul, 0x00000000ul,   0 }, /*  3 */
+    { 0x00000000ul, 0x00000000ul,   0 }, /*  4 */
+    { 0x50000000ul, 0x00000000ul,   0 }, /*  5 */
+    { 0xb8000000ul, 0x00000014ul,  10 }, /*  6 */
+    { 0xf8000000ul, 0x0000005cul,  36 }, /*  7 */
+    { 0xfe000000ul, 0x000000f8ul,  68 }, /*  8 */
+    { 0xfe000000ul, 0x00000000ul,   0 }, /*  9 */
+    { 0xff400000ul, 0x000003f8ul,  74 }, /* 10 */
+    { 0xffa00000ul, 0x000007faul,  79 }, /* 11 */
+    { 0xffc00000ul, 0x00000ffaul,  82 }, /* 12 */
+    { 0xfff00000ul, 0x00001ff8ul,  84 }, /* 13 */
+    { 0xfff80000ul, 0x00003ffcul,  90 }, /* 14 */
+    { 0xfffe0000ul, 0x00007ffcul,  92 }, /* 15 */
+    { 0xfffe0000ul, 0x00000000ul,   0 }, /* 16 */
+    { 0xfffe0000ul, 0x00000000ul,   0 }, /* 17 */
+    { 0xfffe0000ul, 0x00000000ul,   0 }, /* 18 */
+    { 0xfffe6000ul, 0x0007fff0ul,  95 }, /* 19 */
+    { 0xfffee000ul, 0x000fffe6ul,  98 }, /* 20 */
+    { 0xffff4800ul, 0x001fffdcul, 106 }, /* 21 */
+    { 0xffffb000ul, 0x003fffd2ul, 119 }, /* 22 */
+    { 0xffffea00ul, 0x007fffd8ul, 145 }, /* 23 */
+    { 0xfffff600ul, 0x00ffffeaul, 174 }, /* 24 */
+    { 0xfffff800ul, 0x01ffffecul, 186 }, /* 25 */
+    { 0xfffffbc0ul, 0x03ffffe0ul, 190 }, /* 26 */
+    { 0xfffffe20ul, 0x07ffffdeul, 205 }, /* 27 */
+    { 0xfffffff0ul, 0x0fffffe2ul, 224 }, /* 28 */
+    { 0xfffffff0ul, 0x00000000ul,   0 }, /* 29 */
+    { 0xfffffffful, 0x3ffffffcul, 253 }, /* 30 */
+};
+
+static const unsigned short _symbols[257] = {
+     48,  49,  50,  97,  99, 101, 105, 111, 115, 116,  32,  37,
+     45,  46,  47,  51,  52,  53,  54,  55,  56,  57,  61,  65,
+     95,  98, 100, 102, 103, 104, 108, 109, 110, 112, 114, 117,
+     58,  66,  67,  68,  69,  70,  71,  72,  73,  74,  75,  76,
+     77,  78,  79,  80,  81,  82,  83,  84,  85,  86,  87,  89,
+    106, 107, 113, 118, 119, 120, 121, 122,  38,  42,  44,  59,
+     88,  90,  33,  34,  40,  41,  63,  39,  43, 124,  35,  62,
+      0,  36,  64,  91,  93, 126,  94, 125,  60,  96, 123,  92,
+    195, 208, 128, 130, 131, 162, 184, 194, 224, 226, 153, 161,
+    167, 172, 176, 177, 179, 209, 216, 217, 227, 229, 230, 129,
+    132, 133, 134, 136, 146, 154, 156, 160, 163, 164, 169, 170,
+    173, 178, 181, 185, 186, 187, 189, 190, 196, 198, 228, 232,
+    233,   1, 135, 137, 138, 139, 140, 141, 143, 147, 149, 150,
+    151, 152, 155, 157, 158, 165, 166, 168, 174, 175, 180, 182,
+    183, 188, 191, 197, 231, 239,   9, 142, 144, 145, 148, 159,
+    171, 206, 215, 225, 236, 237, 199, 207, 234, 235, 192, 193,
+    200, 201, 202, 205, 210, 213, 218, 219, 238, 240, 242, 243,
+    255, 203, 204, 211, 212, 214, 221, 222, 223, 241, 244, 245,
+    246, 247, 248, 250, 251, 252, 253, 254,   2,   3,   4,   5,
+      6,   7,   8,  11,  12,  14,  15,  16,  17,  18,  19,  20,
+     21,  23,  24,  25,  26,  27,  28,  29,  30,  31, 127, 220,
+    249,  10,  13,  22, 256,
+};
+
+static int _fold (int c)
+{
+    return (((c >= 'A') && (c <= 'Z'))? (c + ('a'-'A')) : c);
+}
+
+// Compare lowercase text in @a lhs with @a rhs, folding @a rhs if asked to.
+static int _equal (const char * lhs, const char * rhs, size_t size, int fold)
+{
+    size_t i = 0;
+    if (!fold) {
+        return (memcmp(lhs, rhs, size) == 0);
+    }
+    while ((i < size) && (lhs[i] == _fold(rhs[i]))) {
+        ++i;
+    }
+    return (i == size);
+}
+
+/*
+ * Dynamic table.  Entries are written back to back in a ring buffer.  Since
+ * each entry accounts for 32 bytes more than it occupies, entries never
+ * overlap as long as the table size is below the ring's size.
+ */
+
+static size_t _table_slots (size_t limit)
+{
+    return ((limit / 32) + 1);
+}
+
+static int _table_init (http_hpack_table * self, size_t limit)
+{
+    self->data = (char*)malloc((limit > 0)? limit : 1);
+    self->entries = (http_hpack_entry*)malloc(
+        _table_slots(limit) * sizeof(http_hpack_entry));
+    if ((self->data == 0) || (self->entries == 0)) {
+        free(self->data), free(self->entries);
+        self->data = 0, self->entries = 0;
+        return 0;
+    }
+    self->limit = self->capacity = limit;
+    self->size = self->count = 0;
+    self->first = self->next = 0;
+    return 1;
+}
+
+static void _table_kill (http_hpack_table * self)
+{
+    free(self->data), free(self->entries);
+    self->data = 0, self->entries = 0;
+    self->limit = self->capacity = self->size = self->count = 0;
+}
+
+static void _table_evict (http_hpack_table * self, size_t room)
+{
+    // Drop the oldest entries until a new entry of size @a room fits.  When
+    // it is too large, this empties the table, as required.
+    const http_hpack_entry * entry = 0;
+    while ((self->count > 0) && ((self->size + room) > self->capacity))
+    {
+        entry = &self->entries[self->first];
+        self->size -= entry->field_size + entry->value_size + 32;
+        self->first = (self->first + 1) % _table_slots(self->limit);
+        --self->count;
+    }
+}
+
+static void _table_resize (http_hpack_table * self, size_t capacity)
+{
+    self->capacity = capacity;
+    _table_evict(self, 0);
+}
+
+static void _table_write (http_hpack_table * self,
+                          const char * text, size_t size, int fold)
+{
+    size_t span = self->limit - self->next;
+    size_t i = 0;
+    if (span > size) {
+        span = size;
+    }
+    memcpy(self->data+self->next, text, span);
+    memcpy(self->data, text+span, size-span);
+    if (fold) {
+        for (i = 0; i < size; ++i) {
+            char * c = &self->data[(self->next + i) % self->limit];
+            *c = (char)_fold(*c);
+        }
+    }
+    self->next = (self->next + size) % self->limit;
+}
+
+static void _table_add (http_hpack_table * self, size_t base,
+                        size_t field_size, size_t value_size)
+{
+    const size_t slot = (self->first + self->count) % _table_slots(self->limit);
+    self->entries[slot].base = base;
+    self->entries[slot].field_size = field_size;
+    self->entries[slot].value_size = value_size;
+    self->size += field_size + value_size + 32;
+    ++self->count;
+}
+
+// Entry 0 is the newest one.
+static const http_hpack_entry * _table_get (const http_hpack_table * self,
+                                            size_t index)
+{
+    const size_t slot = self->first + self->count - 1 - index;
+    return (&self->entries[slot % _table_slots(self->limit)]);
+}
+
+static size_t _table_wrap (const http_hpack_table * self, size_t offset)
+{
+    return ((offset >= self->limit)? offset - self->limit : offset);
+}
+
+static int _table_equal (const http_hpack_table * self, size_t base,
+                         const char * text, size_t size, int fold)
+{
+    size_t span = self->limit - base;
+    if (span > size) {
+        span = size;
+    }
+    return (_equal(self->data+base, text, span, fold) &&
+            _equal(self->data, text+span, size-span, fold));
+}
+
+/*
+ * Decoder.
+ */
+
+typedef int (*http_push)(http_mark * mark, const char * data, size_t size);
+
+static int _push (http_mark * mark, http_push push,
+                  const char * data, size_t size)
+{
+    // Pushes stop at null characters, which are not allowed in HTTP/2.
+    const size_t used = mark->head->used;
+    return (push(mark, data, size) && ((mark->head->used - used) == size));
+}
+
+static int _push_ring (const http_hpack_table * table, http_mark * mark,
+                       http_push push, size_t base, size_t size)
+{
+    size_t span = table->limit - base;
+    if (span > size) {
+        span = size;
+    }
+    return (_push(mark, push, table->data+base, span) &&
+            _push(mark, push, table->data, size-span));
+}
+
+static int _integer (const unsigned char ** next, const unsigned char * stop,
+                     int prefix, size_t * value)
+{
+    const size_t mask = ((size_t)1 << prefix) - 1;
+    const unsigned char * data = *next;
+    int shift = 0;
+    if (data == stop) {
+        return 0;
+    }
+    if ((*value = (*data++ & mask)) == mask)
+    {
+        // Up to 4 continuation bytes, which keeps values below 2^28+mask.
+        do {
+            if ((data == stop) || (shift > 21)) {
+                return 0;
+            }
+            *value += (size_t)(*data & 0x7f) << shift, shift += 7;
+        }
+        while ((*data++ & 0x80) != 0);
+    }
+    *next = data;
+    return 1;
+}
+
+static int _huffman (http_mark * mark, http_push push,
+                     const unsigned char * data, size_t size)
+{
+    const unsigned char * stop = data + size;
+    unsigned long long window = 0;
+    unsigned long code = 0;
+    unsigned int symbol = 0;
+    int bits = 0;
+    int length = 0;
+    char chunk[64];
+    size_t used = 0;
+    for (;;)
+    {
+        // Pending bits are left-aligned.  Keep at least 32 of them while
+        // input remains.
+        while ((bits <= 56) && (data < stop)) {
+            window |= (unsigned long long)*data++ << (56 - bits), bits += 8;
+        }
+        if (bits == 0) {
+            break;
+        }
+        code = (unsigned long)(window >> 32);
+        symbol = _fast[code >> 24].symbol;
+        length = _fast[code >> 24].bits;
+        if (length == 0)
+        {
+            for (length = 9; length < 30; ++length) {
+                if (code < _lengths[length].limit) {
+                    break;
+                }
+            }
+            symbol = _symbols[_lengths[length].offset +
+                (code >> (32 - length)) - _lengths[length].first];
+        }
+        // Out of input: what remains must be padding, i.e. the first 7 bits
+        // of EOS at most.
+        if (length > bits) {
+            if ((bits > 7) ||
+                ((window >> (64 - bits)) != ((1u << bits) - 1))) {
+                return 0;
+            }
+            break;
+        }
+        if (symbol == 256) {
+            return 0;
+        }
+        window <<= length, bits -= length;
+        chunk[used++] = (char)symbol;
+        if (used == sizeof(chunk)) {
+            if (!_push(mark, push, chunk, used)) {
+                return 0;
+            }
+            used = 0;
+        }
+    }
+    return (_push(mark, push, chunk, used));
+}
+
+static int _string (http_mark * mark, http_push push,
+                    const unsigned char ** next, const unsigned char * stop)
+{
+    const int huffman = (*next < stop) && ((**next & 0x80) != 0);
+    const unsigned char * data = 0;
+    size_t size = 0;
+    if (!_integer(next, stop, 7, &size) || (size > (size_t)(stop - *next))) {
+        return 0;
+    }
+    data = *next, *next += size;
+    if (huffman) {
+        return (_huffman(mark, push, data, size));
+    }
+    return (_push(mark, push, (const char*)data, size));
+}
+
+// Push the name of entry @a index in the static or dynamic table.
+static int _field (const http_hpack_table * table, http_mark * mark,
+                   size_t index)
+{
+    const http_hpack_entry * entry = 0;
+    if (index < HPACK_DYNAMIC) {
+        return (_push(mark, http_head_push_field,
+            _static[index-1].field, _static[index-1].field_size));
+    }
+    if ((index - HPACK_DYNAMIC) >= table->count) {
+        return 0;
+    }
+    entry = _table_get(table, index-HPACK_DYNAMIC);
+    return (_push_ring(table, mark, http_head_push_field,
+                       entry->base, entry->field_size));
+}
+
+// Push the data of entry @a index in the static or dynamic table.
+static int _value (const http_hpack_table * table, http_mark * mark,
+                   size_t index)
+{
+    const http_hpack_entry * entry = 0;
+    if (index < HPACK_DYNAMIC) {
+        return (_push(mark, http_head_push_value,
+            _static[index-1].value, _static[index-1].value_size));
+    }
+    entry = _table_get(table, index-HPACK_DYNAMIC);
+    return (_push_ring(table, mark, http_head_push_value,
+        _table_wrap(table, entry->base+entry->field_size), entry->value_size));
+}
+
+static int _decode (http_hpack_table * table, http_head * head,
+                    const unsigned char ** next, const unsigned char * stop)
+{
+    const int indexed = ((**next & 0x80) != 0);
+    const int insert = ((**next & 0xc0) == 0x40);
+    http_mark mark;
+    size_t index = 0;
+    size_t base = 0;
+    size_t field_size = 0;
+    size_t value_size = 0;
+    if (!http_head_mark(head, &mark) ||
+        !_integer(next, stop, indexed? 7 : insert? 6 : 4, &index)) {
+        return 0;
+    }
+    // Indexed header field.
+    if (indexed) {
+        return ((index > 0) && _field(table, &mark, index) &&
+                http_head_push_value(&mark, "", 0) &&
+                _value(table, &mark, index) && http_head_commit(&mark));
+    }
+    // Literal header field, with the name indexed or literal.
+    if ((index > 0)? !_field(table, &mark, index) :
+        !_string(&mark, http_head_push_field, next, stop)) {
+        return 0;
+    }
+    // Copy the name into the dynamic table now: inserting the new entry may
+    // evict the one it refers to and switching to data may tokenize it.
+    field_size = head->used - mark.base;
+    if (insert) {
+        _table_evict(table, field_size + 32), base = table->next;
+        if ((field_size + 32) <= table->capacity) {
+            _table_write(table, head->data+mark.base, field_size, 0);
+        }
+    }
+    if (!http_head_push_value(&mark, "", 0) ||
+        !_string(&mark, http_head_push_value, next, stop)) {
+        return 0;
+    }
+    value_size = head->used - mark.value_base;
+    if (insert) {
+        _table_evict(table, field_size + value_size + 32);
+        if ((field_size + value_size + 32) <= table->capacity) {
+            _table_write(table, head->data+mark.value_base, value_size, 0);
+            _table_add(table, base, field_size, value_size);
+        }
+    }
+    return (http_head_commit(&mark));
+}
+
+int http_hpack_decoder_init (http_hpack_decoder * self, size_t limit)
+{
+    return (_table_init(&self->table, limit));
+}
+
+void http_hpack_decoder_kill (http_hpack_decoder * self)
+{
+    _table_kill(&self->table);
+}
+
+int http_hpack_decode (http_hpack_decoder * self, http_head * head,
+                       const char * data, size_t size)
+{
+    const unsigned char * next = (const unsigned char*)data;
+    const unsigned char * stop = next + size;
+    size_t fields = 0;
+    size_t capacity = 0;
+    int status = 1;
+    http_mark block;
+    if (!http_head_mark(head, &block)) {
+        return 0;
+    }
+    while (status && (next < stop))
+    {
+        // Dynamic table size updates may only start the header block.
+        if ((*next & 0xe0) == 0x20) {
+            status = (fields == 0) && _integer(&next, stop, 5, &capacity) &&
+                (capacity <= self->table.limit);
+            if (status) {
+                _table_resize(&self->table, capacity);
+            }
+            continue;
+        }
+        status = _decode(&self->table, head, &next, stop), ++fields;
+    }
+    // Drop everything from a bad header block.
+    if (!status) {
+        http_head_cancel(&block);
+    }
+    return (status);
+}
+
+/*
+ * Encoder.
+ */
+
+typedef struct http_output
+{
+    unsigned char * data;
+    size_t size;
+    size_t used;
+} http_output;
+
+static int _put (http_output * self, size_t byte)
+{
+    if (self->used == self->size) {
+        return 0;
+    }
+    self->data[self->used++] = (unsigned char)byte;
+    return 1;
+}
+
+static int _put_integer (http_output * self, unsigned char code,
+                         int prefix, size_t value)
+{
+    const size_t mask = ((size_t)1 << prefix) - 1;
+    if (value < mask) {
+        return (_put(self, code | value));
+    }
+    if (!_put(self, code | mask)) {
+        return 0;
+    }
+    for (value -= mask; value >= 0x80; value >>= 7) {
+        if (!_put(self, (value & 0x7f) | 0x80)) {
+            return 0;
+        }
+    }
+    return (_put(self, value));
+}
+
+static int _put_string (http_output * self,
+                        const char * text, size_t size, int fold)
+{
+    unsigned long long window = 0;
+    int bits = 0;
+    size_t total = 0;
+    size_t i = 0;
+    const http_huffman_code * code = 0;
+    for (i = 0; i < size; ++i) {
+        total += _codes[(unsigned char)(fold? _fold(text[i]) : text[i])].bits;
+    }
+    total = (total + 7) / 8;
+    // Send the string as is unless the Huffman code is shorter.
+    if (total >= size) {
+        if (!_put_integer(self, 0x00, 7, size) ||
+            ((self->size - self->used) < size)) {
+            return 0;
+        }
+        for (i = 0; i < size; ++i) {
+            self->data[self->used++] =
+                (unsigned char)(fold? _fold(text[i]) : text[i]);
+        }
+        return 1;
+    }
+    if (!_put_integer(self, 0x80, 7, total) ||
+        ((self->size - self->used) < total)) {
+        return 0;
+    }
+    for (i = 0; i < size; ++i)
+    {
+        code = &_codes[(unsigned char)(fold? _fold(text[i]) : text[i])];
+        window = (window << code->bits) | code->code, bits += code->bits;
+        for (; bits >= 8; bits -= 8) {
+            self->data[self->used++] = (unsigned char)(window >> (bits - 8));
+        }
+    }
+    // Pad with the most significant bits of EOS.
+    if (bits > 0) {
+        self->data[self->used++] =
+            (unsigned char)((window << (8 - bits)) | (0xff >> bits));
+    }
+    return 1;
+}
+
+static int _sensitive (const char * field, size_t size, int fold)
+{
+    return (((size == 13) &&
+             _equal("authorization", field, size, fold)) ||
+            ((size == 19) &&
+             _equal("proxy-authorization", field, size, fold)));
+}
+
+/*
+ * Look for a header in the static and dynamic tables.  Sets @a index to the
+ * entry matching both name and data, if any, else @a name to the first entry
+ * with the same name, if any.  Unless @a fold is set, @a field must already
+ * be in lowercase.
+ */
+static void _lookup (const http_hpack_table * table,
+                     const char * field, size_t field_size,
+                     const char * value, size_t value_size,
+                     size_t * index, size_t * name, int fold)
+{
+    const http_hpack_entry * entry = 0;
+    size_t i = 0;
+    for (i = 0; i < (HPACK_DYNAMIC-1); ++i)
+    {
+        if ((_static[i].field_size != field_size) ||
+            !_equal(_static[i].field, field, field_size, fold)) {
+            continue;
+        }
+        if (*name == 0) {
+            *name = i + 1;
+        }
+        if ((_static[i].value_size == value_size) &&
+            _equal(_static[i].value, value, value_size, 0)) {
+            *index = i + 1;
+            return;
+        }
+    }
+    for (i = 0; i < table->count; ++i)
+    {
+        entry = _table_get(table, i);
+        if ((entry->field_size != field_size) ||
+            !_table_equal(table, entry->base, field, field_size, fold)) {
+            continue;
+        }
+        if (*name == 0) {
+            *name = i + HPACK_DYNAMIC;
+        }
+        if ((entry->value_size == value_size) && _table_equal(table,
+                _table_wrap(table, entry->base+field_size),
+                value, value_size, 0)) {
+            *index = i + HPACK_DYNAMIC;
+            return;
+        }
+    }
+}
+
+static int _encode (http_hpack_table * table, http_output * output,
+                    const http_cursor * cursor)
+{
+    // Lowercase heads spare us from folding names.
+    const int fold = (cursor->head->options & HTTP_HEAD_LOWERCASE) == 0;
+    const size_t room = cursor->field_size + cursor->value_size + 32;
+    size_t index = 0;
+    size_t name = 0;
+    size_t base = 0;
+    int insert = 0;
+    _lookup(table, cursor->field, cursor->field_size,
+            cursor->value, cursor->value_size, &index, &name, fold);
+    if (index > 0) {
+        return (_put_integer(output, 0x80, 7, index));
+    }
+    // Literal header field: never indexed, with incremental indexing or
+    // without indexing when the entry can't fit in the table.
+    if (_sensitive(cursor->field, cursor->field_size, fold)) {
+        if (!_put_integer(output, 0x10, 4, name)) {
+            return 0;
+        }
+    }
+    else if (room <= table->capacity) {
+        if (!_put_integer(output, 0x40, 6, name)) {
+            return 0;
+        }
+        insert = 1;
+    }
+    else if (!_put_integer(output, 0x00, 4, name)) {
+        return 0;
+    }
+    if (((name == 0) &&
+         !_put_string(output, cursor->field, cursor->field_size, fold)) ||
+        !_put_string(output, cursor->value, cursor->value_size, 0)) {
+        return 0;
+    }
+    if (insert) {
+        _table_evict(table, room), base = table->next;
+        _table_write(table, cursor->field, cursor->field_size, fold);
+        _table_write(table, cursor->value, cursor->value_size, 0);
+        _table_add(table, base, cursor->field_size, cursor->value_size);
+    }
+    return 1;
+}
+
+int http_hpack_encoder_init (http_hpack_encoder * self, size_t limit)
+{
+    // The peer's table size is unknown: always start with an update.
+    self->minimum = limit;
+    self->update = 1;
+    return (_table_init(&self->table, limit));
+}
+
+void http_hpack_encoder_kill (http_hpack_encoder * self)
+{
+    _table_kill(&self->table);
+}
+
+void http_hpack_encoder_resize (http_hpack_encoder * self, size_t size)
+{
+    if (size > self->table.limit) {
+        size = self->table.limit;
+    }
+    if (size < self->minimum) {
+        self->minimum = size;
+    }
+    _table_resize(&self->table, size);
+    self->update = 1;
+}
+
+static int _encode_block (http_hpack_encoder * self, http_output * output,
+                          const http_head * head)
+{
+    const size_t capacity = self->table.capacity;
+    http_cursor cursor;
+    // Signal the smallest size since the last block, then the current size.
+    if (self->update) {
+        if ((self->minimum < capacity) &&
+            !_put_integer(output, 0x20, 5, self->minimum)) {
+            return 0;
+        }
+        if (!_put_integer(output, 0x20, 5, capacity)) {
+            return 0;
+        }
+    }
+    http_cursor_init(&cursor, head);
+    while (http_cursor_next(&cursor)) {
+        if (!_encode(&self->table, output, &cursor)) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+size_t http_hpack_encode (http_hpack_encoder * self, const http_head * head,
+                          char * data, size_t size)
+{
+    const size_t capacity = self->table.capacity;
+    http_output output;
+    output.data = (unsigned char*)data;
+    output.size = size;
+    output.used = 0;
+    if (!_encode_block(self, &output, head)) {
+        // The peer never sees this block, but the table may have changed.
+        // Clear it and have the peer do the same before the next block.
+        _table_resize(&self->table, 0);
+        _table_resize(&self->table, capacity);
+        self->minimum = 0;
+        self->update = 1;
+        return 0;
+    }
+    self->minimum = capacity;
+    self->update = 0;
+    return (output.used);
+}
@@ -0,0 +1,265 @@
+#ifndef _chttp_hpack_h__
+#define _chttp_hpack_h__
+
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+/*!
+ * @file
+ * @brief HPACK (RFC 7541) header compression for HTTP/2.
+ *
+ * Decoded headers are pushed straight into an @c http_head through the
+ * partial push API, so header names and data are copied once.  Pseudo-header
+ * fields such as @c :method are stored like any other header.
+ */
+
+#include "chttp.h"
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/*!
+ * @private
+ * @brief Location of an entry in an HPACK dynamic table.
+ */
+typedef struct http_hpack_entry
+{
+    size_t base;
+    size_t field_size;
+    size_t value_size;
+
+} http_hpack_entry;
+
+/*!
+ * @brief HPACK dynamic table.
+ *
+ * Entries are stored back to back in a ring buffer sized for the largest
+ * table allowed, so insertion never allocates.
+ */
+typedef struct http_hpack_table
+{
+    /*!
+     * @private
+     * @brief Ring buffer holding header names and data.
+     */
+    char * data;
+
+    /*!
+     * @private
+     * @brief Ring of entries, oldest first.
+     */
+    http_hpack_entry * entries;
+
+    /*!
+     * @private
+     * @brief Size of @c data, which is also the largest table size allowed.
+     */
+    size_t limit;
+
+    /*!
+     * @private
+     * @brief Current maximum table size, at most @c limit.
+     */
+    size_t capacity;
+
+    /*!
+     * @private
+     * @brief Current table size, as defined in RFC 7541, section 4.1.
+     */
+    size_t size;
+
+    /*!
+     * @private
+     * @brief Number of entries in the table.
+     */
+    size_t count;
+
+    /*!
+     * @private
+     * @brief Position of the oldest entry in @c entries.
+     */
+    size_t first;
+
+    /*!
+     * @private
+     * @brief Offset in @c data at which the next entry is written.
+     */
+    size_t next;
+
+} http_hpack_table;
+
+/*!
+ * @brief Per-connection state for decoding header blocks.
+ *
+ * @code
+ *  http_hpack_decoder decoder;
+ *  http_hpack_decoder_init(&decoder, 4096);
+ *  // For each HEADERS frame (and its CONTINUATION frames):
+ *  http_head_reset(&head);
+ *  if (!http_hpack_decode(&decoder, &head, block, size)) {
+ *    // Connection error of type COMPRESSION_ERROR.
+ *  }
+ *  http_hpack_decoder_kill(&decoder);
+ * @endcode
+ *
+ * @see http_hpack_decoder_init
+ * @see http_hpack_decode
+ */
+typedef struct http_hpack_decoder
+{
+    /*!
+     * @private
+     * @brief Dynamic table.
+     */
+    http_hpack_table table;
+
+} http_hpack_decoder;
+
+/*!
+ * @brief Initialize a decoder.
+ * @param self
+ * @param limit Value of @c SETTINGS_HEADER_TABLE_SIZE advertised to the peer.
+ *  The peer's encoder may not use a larger dynamic table.
+ * @return 0 on failure (e.g. out of memory), else non-zero.
+ *
+ * @memberof http_hpack_decoder
+ */
+int http_hpack_decoder_init (http_hpack_decoder * self, size_t limit);
+
+/*!
+ * @brief Release resources held by the decoder.
+ * @param self
+ *
+ * @memberof http_hpack_decoder
+ */
+void http_hpack_decoder_kill (http_hpack_decoder * self);
+
+/*!
+ * @brief Decode a complete header block, appending its headers to @a head.
+ * @param self
+ * @param head Buffer that receives the headers.
+ * @param data Header block fragments, concatenated.
+ * @param size Number of valid bytes starting at @a data.
+ * @return 0 on failure (e.g. the block is malformed or the headers don't fit
+ *  in @a head), else non-zero.
+ *
+ * On failure, headers decoded from this block are removed from @a head and
+ * the dynamic table is left in an unspecified state: the connection must be
+ * closed.  Huffman-encoded strings are decoded using lookup tables, 8 bits
+ * at a time for the most frequent characters.
+ *
+ * @memberof http_hpack_decoder
+ */
+int http_hpack_decode (http_hpack_decoder * self, http_head * head,
+                       const char * data, size_t size);
+
+/*!
+ * @brief Per-connection state for encoding header blocks.
+ *
+ * @see http_hpack_encoder_init
+ * @see http_hpack_encode
+ */
+typedef struct http_hpack_encoder
+{
+    /*!
+     * @private
+     * @brief Dynamic table.
+     */
+    http_hpack_table table;
+
+    /*!
+     * @private
+     * @brief Smallest table size set since the last header block.
+     */
+    size_t minimum;
+
+    /*!
+     * @private
+     * @brief Non-zero if the next header block must start with dynamic table
+     *  size updates.
+     */
+    int update;
+
+} http_hpack_encoder;
+
+/*!
+ * @brief Initialize an encoder.
+ * @param self
+ * @param limit Largest dynamic table the encoder will use.  This should not
+ *  exceed the peer's @c SETTINGS_HEADER_TABLE_SIZE, which defaults to 4096.
+ * @return 0 on failure (e.g. out of memory), else non-zero.
+ *
+ * @memberof http_hpack_encoder
+ */
+int http_hpack_encoder_init (http_hpack_encoder * self, size_t limit);
+
+/*!
+ * @brief Release resources held by the encoder.
+ * @param self
+ *
+ * @memberof http_hpack_encoder
+ */
+void http_hpack_encoder_kill (http_hpack_encoder * self);
+
+/*!
+ * @brief Change the dynamic table size, e.g. when the peer changes its @c
+ *  SETTINGS_HEADER_TABLE_SIZE.
+ * @param self
+ * @param size New table size.  Values larger than the limit passed to @c
+ *  http_hpack_encoder_init are clamped.
+ *
+ * The change is signaled to the peer at the start of the next header block.
+ *
+ * @memberof http_hpack_encoder
+ */
+void http_hpack_encoder_resize (http_hpack_encoder * self, size_t size);
+
+/*!
+ * @brief Encode all headers in @a head as a single header block.
+ * @param self
+ * @param head Headers to encode.  Names are converted to lowercase.
+ * @param data Output buffer.
+ * @param size Size of @a data, in bytes.
+ * @return The number of bytes written to @a data, or 0 if the header block
+ *  doesn't fit.
+ *
+ * When the block doesn't fit, the dynamic table is cleared and the next
+ * header block starts with dynamic table size updates that make the peer
+ * clear its table too, so the encoder remains usable.
+ *
+ * Authorization headers are never indexed.  Strings are Huffman-encoded
+ * when that makes them shorter.
+ *
+ * @memberof http_hpack_encoder
+ */
+size_t http_hpack_encode (http_hpack_encoder * self, const http_head * head,
+                          char * data, size_t size);
+
+#ifdef __cplusplus
+}
+#endif
+
+#endif /* _chttp_hpack_h__ */
@@ -29,205 +29,2606 @@
  */
 
 #include "chttp.h"
-#include <malloc.h>
+#include <limits.h>
+#include <stdlib.h>
 #include <string.h>
+#if !defined(_WIN32)
+#   include <sys/uio.h>
+#endif
 
-static size_t next_segment (char ** segment)
+#if defined(__SSE2__) || defined(_M_X64) || \
+    (defined(_M_IX86_FP) && (_M_IX86_FP >= 2))
+#   define CHTTP_SSE2 1
+#   include <emmintrin.h>
+#endif
+#if defined(CHTTP_SSE2) && defined(__GNUC__)
+#   define CHTTP_AVX2 1
+#   include <immintrin.h>
+#endif
+#if defined(_MSC_VER)
+#   include <intrin.h>
+#endif
+
+// Aligned over-reads are intentional, see below.
+#if defined(__GNUC__)
+#   define CHTTP_UNCHECKED __attribute__((no_sanitize_address))
+#else
+#   define CHTTP_UNCHECKED
+#endif
+
+/*
+ * Instrumentation, see http_stats.  Counters are updated with relaxed atomic
+ * operations: they are only ever read for monitoring.
+ */
+#if defined(CHTTP_STATS)
+static http_stats _stats;
+static http_stats_hook _hook = 0;
+static void * _hook_context = 0;
+
+static void _count (unsigned long long * counter, unsigned long long delta)
+{
+#if defined(_MSC_VER)
+    _InterlockedExchangeAdd64((volatile __int64*)counter, (__int64)delta);
+#else
+    __atomic_fetch_add(counter, delta, __ATOMIC_RELAXED);
+#endif
+}
+
+static void _peak (unsigned long long * counter, unsigned long long value)
+{
+#if defined(_MSC_VER)
+    __int64 last = *(volatile __int64*)counter;
+    __int64 seen = 0;
+    while ((unsigned long long)last < value)
+    {
+        seen = _InterlockedCompareExchange64((volatile __int64*)counter,
+                                             (__int64)value, last);
+        if (seen == last) {
+            break;
+        }
+        last = seen;
+    }
+#else
+    unsigned long long last = __atomic_load_n(counter, __ATOMIC_RELAXED);
+    while ((last < value) && !__atomic_compare_exchange_n(counter,
+                &last, value, 1, __ATOMIC_RELAXED, __ATOMIC_RELAXED)) {
+    }
+#endif
+}
+
+static void _fail (const http_head * head, http_stats_event event)
+{
+    _count((event == HTTP_STATS_OVERFLOW)?
+           &_stats.overflows : &_stats.rejects, 1);
+    if (_hook != 0) {
+        _hook(_hook_context, head, event);
+    }
+}
+
+#   define CHTTP_COUNT(counter, delta) _count(&_stats.counter, (delta))
+#   define CHTTP_PEAK(counter, value) _peak(&_stats.counter, (value))
+#   define CHTTP_FAIL(head, event) _fail((head), (event))
+#else
+#   define CHTTP_COUNT(counter, delta) ((void)(delta))
+#   define CHTTP_PEAK(counter, value) ((void)(value))
+#   define CHTTP_FAIL(head, event) ((void)0)
+#endif
+
+#if defined(CHTTP_SSE2)
+static size_t _ctz (unsigned int mask)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, mask);
+    return (index);
+#else
+    return (__builtin_ctz(mask));
+#endif
+}
+#endif
+
+/*
+ * Segment scanners.  Each one returns the offset of the first null character
+ * in the first @a size bytes at @a text, or @a size if there is none.
+ *
+ * The vector versions only perform aligned loads and may therefore inspect a
+ * few bytes past either end of the range.  These never cross a page boundary,
+ * so this is safe, but the extra bytes must be ignored.
+ */
+typedef size_t (*http_scan)(const char * text, size_t size);
+
+#if !defined(CHTTP_SSE2)
+static size_t _scan_byte (const char * text, size_t size)
+{
+    const char * null = memchr(text, '\0', size);
+    return ((null == 0)? size : (size_t)(null - text));
+}
+#endif
+
+#if defined(CHTTP_SSE2)
+CHTTP_UNCHECKED
+static size_t _scan_sse2 (const char * text, size_t size)
+{
+    const __m128i zero = _mm_setzero_si128();
+    const char * next = (const char*)((size_t)text & ~(size_t)15);
+    unsigned int mask = (unsigned int)_mm_movemask_epi8(
+        _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)next), zero));
+    // Ignore matches before the start of the range.
+    mask &= ~0u << (text - next);
+    while (mask == 0)
+    {
+        next += 16;
+        if ((size_t)(next - text) >= size) {
+            return (size);
+        }
+        mask = (unsigned int)_mm_movemask_epi8(
+            _mm_cmpeq_epi8(_mm_load_si128((const __m128i*)next), zero));
+    }
+    size = (size < (size_t)(next - text) + _ctz(mask))?
+        size : (size_t)(next - text) + _ctz(mask);
+    return (size);
+}
+#endif
+
+#if defined(CHTTP_AVX2)
+CHTTP_UNCHECKED __attribute__((target("avx2")))
+static size_t _scan_avx2 (const char * text, size_t size)
+{
+    const __m256i zero = _mm256_setzero_si256();
+    const char * next = (const char*)((size_t)text & ~(size_t)31);
+    unsigned int mask = (unsigned int)_mm256_movemask_epi8(
+        _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)next), zero));
+    // Ignore matches before the start of the range.
+    mask &= ~0u << (text - next);
+    while (mask == 0)
+    {
+        next += 32;
+        if ((size_t)(next - text) >= size) {
+            return (size);
+        }
+        mask = (unsigned int)_mm256_movemask_epi8(
+            _mm256_cmpeq_epi8(_mm256_load_si256((const __m256i*)next), zero));
+    }
+    size = (size < (size_t)(next - text) + _ctz(mask))?
+        size : (size_t)(next - text) + _ctz(mask);
+    return (size);
+}
+#endif
+
+#if defined(CHTTP_AVX2)
+/*
+ * AVX2 kernels are selected on first use, based on what the processor
+ * supports.  Threads may race to select them, so the function pointers are
+ * only accessed atomically.  Every thread picks the same kernel, so relaxed
+ * ordering is enough.
+ */
+#   define CHTTP_KERNEL(slot) __atomic_load_n(&(slot), __ATOMIC_RELAXED)
+#   define CHTTP_SELECT(slot, kernel) \
+        __atomic_store_n(&(slot), (kernel), __ATOMIC_RELAXED)
+
+static size_t _scan_init (const char * text, size_t size);
+
+static http_scan _scan = _scan_init;
+
+static size_t _scan_init (const char * text, size_t size)
+{
+    const http_scan scan = __builtin_cpu_supports("avx2")?
+        _scan_avx2 : _scan_sse2;
+    CHTTP_SELECT(_scan, scan);
+    return (scan(text, size));
+}
+#else
+// Other kernels are known at compile time.
+#   define CHTTP_KERNEL(slot) (slot)
+#   if defined(CHTTP_SSE2)
+static const http_scan _scan = _scan_sse2;
+#   else
+static const http_scan _scan = _scan_byte;
+#   endif
+#endif
+
+/*
+ * Delimiter finders.  Each one returns the offset of the first byte in the
+ * first @a size bytes at @a text that matches any of the 4 bytes in @a set,
+ * or @a size if there is none.  The same over-read rules apply.
+ */
+typedef size_t (*http_find)(const char * text, size_t size, const char * set);
+
+#if !defined(CHTTP_SSE2)
+static size_t _find_byte (const char * text, size_t size, const char * set)
+{
+    size_t used = 0;
+    for (; used < size; ++used)
+    {
+        if ((text[used] == set[0]) || (text[used] == set[1]) ||
+            (text[used] == set[2]) || (text[used] == set[3])) {
+            break;
+        }
+    }
+    return (used);
+}
+#endif
+
+#if defined(CHTTP_SSE2)
+CHTTP_UNCHECKED
+static unsigned int _match_sse2 (const char * next, const __m128i * set)
+{
+    const __m128i data = _mm_load_si128((const __m128i*)next);
+    return ((unsigned int)_mm_movemask_epi8(_mm_or_si128(
+        _mm_or_si128(_mm_cmpeq_epi8(data, set[0]),
+                     _mm_cmpeq_epi8(data, set[1])),
+        _mm_or_si128(_mm_cmpeq_epi8(data, set[2]),
+                     _mm_cmpeq_epi8(data, set[3])))));
+}
+
+static size_t _find_sse2 (const char * text, size_t size, const char * set)
+{
+    const __m128i bytes[4] = {
+        _mm_set1_epi8(set[0]), _mm_set1_epi8(set[1]),
+        _mm_set1_epi8(set[2]), _mm_set1_epi8(set[3]),
+    };
+    const char * next = (const char*)((size_t)text & ~(size_t)15);
+    unsigned int mask = _match_sse2(next, bytes);
+    // Ignore matches before the start of the range.
+    mask &= ~0u << (text - next);
+    while (mask == 0)
+    {
+        next += 16;
+        if ((size_t)(next - text) >= size) {
+            return (size);
+        }
+        mask = _match_sse2(next, bytes);
+    }
+    size = (size < (size_t)(next - text) + _ctz(mask))?
+        size : (size_t)(next - text) + _ctz(mask);
+    return (size);
+}
+#endif
+
+#if defined(CHTTP_AVX2)
+CHTTP_UNCHECKED __attribute__((target("avx2")))
+static unsigned int _match_avx2 (const char * next, const __m256i * set)
+{
+    const __m256i data = _mm256_load_si256((const __m256i*)next);
+    return ((unsigned int)_mm256_movemask_epi8(_mm256_or_si256(
+        _mm256_or_si256(_mm256_cmpeq_epi8(data, set[0]),
+                        _mm256_cmpeq_epi8(data, set[1])),
+        _mm256_or_si256(_mm256_cmpeq_epi8(data, set[2]),
+                        _mm256_cmpeq_epi8(data, set[3])))));
+}
+
+__attribute__((target("avx2")))
+static size_t _find_avx2 (const char * text, size_t size, const char * set)
+{
+    const __m256i bytes[4] = {
+        _mm256_set1_epi8(set[0]), _mm256_set1_epi8(set[1]),
+        _mm256_set1_epi8(set[2]), _mm256_set1_epi8(set[3]),
+    };
+    const char * next = (const char*)((size_t)text & ~(size_t)31);
+    unsigned int mask = _match_avx2(next, bytes);
+    // Ignore matches before the start of the range.
+    mask &= ~0u << (text - next);
+    while (mask == 0)
+    {
+        next += 32;
+        if ((size_t)(next - text) >= size) {
+            return (size);
+        }
+        mask = _match_avx2(next, bytes);
+    }
+    size = (size < (size_t)(next - text) + _ctz(mask))?
+        size : (size_t)(next - text) + _ctz(mask);
+    return (size);
+}
+#endif
+
+#if defined(CHTTP_AVX2)
+static size_t _find_init (const char * text, size_t size, const char * set);
+
+static http_find _find = _find_init;
+
+static size_t _find_init (const char * text, size_t size, const char * set)
+{
+    const http_find find = __builtin_cpu_supports("avx2")?
+        _find_avx2 : _find_sse2;
+    CHTTP_SELECT(_find, find);
+    return (find(text, size, set));
+}
+#elif defined(CHTTP_SSE2)
+static const http_find _find = _find_sse2;
+#else
+static const http_find _find = _find_byte;
+#endif
+
+static size_t next_segment (const char * segment, size_t size)
+{
+    return (CHTTP_KERNEL(_scan)(segment, size));
+}
+
+static int _fold (int c)
+{
+    return (((c >= 'A') && (c <= 'Z'))? (c + ('a'-'A')) : c);
+}
+
+static size_t _hash (const char * field, size_t * size)
+{
+    // FNV-1a over case-folded characters, 32 bits.
+    unsigned int hash = 2166136261u;
+    const char * next = field;
+    while (*next != '\0') {
+        hash = (hash ^ (unsigned char)_fold(*next++)) * 16777619u;
+    }
+    *size = (size_t)(next - field);
+    return (hash);
+}
+
+static size_t _hashn (const char * field, size_t size)
+{
+    // FNV-1a over case-folded characters, 32 bits.
+    unsigned int hash = 2166136261u;
+    const char * stop = field + size;
+    while (field < stop) {
+        hash = (hash ^ (unsigned char)_fold(*field++)) * 16777619u;
+    }
+    return (hash);
+}
+
+static int _strnieq (const char * lhs, const char * rhs, size_t size)
+{
+    const char * stop = lhs + size;
+    while ((lhs < stop) && (*lhs != '\0') && (_fold(*lhs) == _fold(*rhs))) {
+        ++lhs, ++rhs;
+    }
+    return (lhs == stop);
+}
+
+#if defined(CHTTP_SSE2)
+static __m128i _fold_sse2 (__m128i data)
+{
+    // Signed compares: bytes past 0x7f are negative and never folded.
+    const __m128i upper = _mm_and_si128(
+        _mm_cmpgt_epi8(data, _mm_set1_epi8('A'-1)),
+        _mm_cmplt_epi8(data, _mm_set1_epi8('Z'+1)));
+    return (_mm_or_si128(data, _mm_and_si128(upper, _mm_set1_epi8(0x20))));
+}
+
+static int _same_sse2 (const char * lhs, const char * rhs, int fold)
+{
+    __m128i lower = _mm_loadu_si128((const __m128i*)lhs);
+    const __m128i other = _fold_sse2(_mm_loadu_si128((const __m128i*)rhs));
+    if (fold) {
+        lower = _fold_sse2(lower);
+    }
+    return (_mm_movemask_epi8(_mm_cmpeq_epi8(lower, other)) == 0xffff);
+}
+#endif
+
+/*
+ * Compare @a size bytes at @a lhs and @a rhs, ignoring ASCII case.  Unlike
+ * @c _strnieq, both ranges must be readable in full.  Unless @a fold is set,
+ * @a lhs must already be in lowercase, which saves folding it.
+ */
+static int _memieq (const char * lhs, const char * rhs, size_t size, int fold)
+{
+    size_t used = 0;
+#if defined(CHTTP_SSE2)
+    if (size >= 16)
+    {
+        for (; (size-used) > 16; used += 16) {
+            if (!_same_sse2(lhs+used, rhs+used, fold)) {
+                return 0;
+            }
+        }
+        // Finish with an overlapping block rather than byte by byte.
+        return (_same_sse2(lhs+size-16, rhs+size-16, fold));
+    }
+#endif
+    for (; used < size; ++used)
+    {
+        if ((fold? _fold(lhs[used]) : lhs[used]) != _fold(rhs[used])) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+// Lowercase @a size bytes at @a text, in place.
+static void _lower (char * text, size_t size)
+{
+    size_t used = 0;
+#if defined(CHTTP_SSE2)
+    for (; (size-used) >= 16; used += 16) {
+        _mm_storeu_si128((__m128i*)(text+used),
+            _fold_sse2(_mm_loadu_si128((const __m128i*)(text+used))));
+    }
+#endif
+    for (; used < size; ++used) {
+        text[used] = (char)_fold(text[used]);
+    }
+}
+
+/*
+ * Well-known header names are stored as a 2 byte token: a marker (which can't
+ * start a valid header name) followed by the token identifier.
+ */
+#define CHTTP_TOKEN '\001'
+
+/*
+ * Removed headers keep their layout, but their name starts with this marker
+ * so that cursors skip them.  Their bytes are reclaimed by compaction.
+ */
+#define CHTTP_DEAD '\002'
+
+typedef struct http_name
+{
+    const char * data;
+    size_t size;
+} http_name;
+
+// Canonical header names, indexed by token identifier.
+static const http_name _names[HTTP_HEADER_COUNT] = {
+    { "", 0 },
+    { "Accept", 6 },
+    { "Accept-Charset", 14 },
+    { "Accept-Encoding", 15 },
+    { "Accept-Language", 15 },
+    { "Accept-Ranges", 13 },
+    { "Access-Control-Allow-Credentials", 32 },
+    { "Access-Control-Allow-Headers", 28 },
+    { "Access-Control-Allow-Methods", 28 },
+    { "Access-Control-Allow-Origin", 27 },
+    { "Access-Control-Expose-Headers", 29 },
+    { "Access-Control-Max-Age", 22 },
+    { "Access-Control-Request-Headers", 30 },
+    { "Access-Control-Request-Method", 29 },
+    { "Age", 3 },
+    { "Allow", 5 },
+    { "Alt-Svc", 7 },
+    { "Authorization", 13 },
+    { "Cache-Control", 13 },
+    { "Connection", 10 },
+    { "Content-Disposition", 19 },
+    { "Content-Encoding", 16 },
+    { "Content-Language", 16 },
+    { "Content-Length", 14 },
+    { "Content-Location", 16 },
+    { "Content-Range", 13 },
+    { "Content-Security-Policy", 23 },
+    { "Content-Type", 12 },
+    { "Cookie", 6 },
+    { "Date", 4 },
+    { "ETag", 4 },
+    { "Expect", 6 },
+    { "Expires", 7 },
+    { "Forwarded", 9 },
+    { "From", 4 },
+    { "Host", 4 },
+    { "If-Match", 8 },
+    { "If-Modified-Since", 17 },
+    { "If-None-Match", 13 },
+    { "If-Range", 8 },
+    { "If-Unmodified-Since", 19 },
+    { "Keep-Alive", 10 },
+    { "Last-Modified", 13 },
+    { "Link", 4 },
+    { "Location", 8 },
+    { "Max-Forwards", 12 },
+    { "Origin", 6 },
+    { "Pragma", 6 },
+    { "Proxy-Authenticate", 18 },
+    { "Proxy-Authorization", 19 },
+    { "Proxy-Connection", 16 },
+    { "Range", 5 },
+    { "Referer", 7 },
+    { "Refresh", 7 },
+    { "Retry-After", 11 },
+    { "Server", 6 },
+    { "Set-Cookie", 10 },
+    { "Strict-Transport-Security", 25 },
+    { "TE", 2 },
+    { "Trailer", 7 },
+    { "Transfer-Encoding", 17 },
+    { "Upgrade", 7 },
+    { "Upgrade-Insecure-Requests", 25 },
+    { "User-Agent", 10 },
+    { "Vary", 4 },
+    { "Via", 3 },
+    { "WWW-Authenticate", 16 },
+    { "X-Content-Type-Options", 22 },
+    { "X-Forwarded-For", 15 },
+    { "X-Forwarded-Host", 16 },
+    { "X-Forwarded-Proto", 17 },
+    { "X-Frame-Options", 15 },
+    { "X-Real-IP", 9 },
+    { "X-Request-ID", 12 },
+    { "X-Requested-With", 16 },
+};
+
+// Same, in lowercase.
+static const http_name _lowercase[HTTP_HEADER_COUNT] = {
+    { "", 0 },
+    { "accept", 6 },
+    { "accept-charset", 14 },
+    { "accept-encoding", 15 },
+    { "accept-language", 15 },
+    { "accept-ranges", 13 },
+    { "access-control-allow-credentials", 32 },
+    { "access-control-allow-headers", 28 },
+    { "access-control-allow-methods", 28 },
+    { "access-control-allow-origin", 27 },
+    { "access-control-expose-headers", 29 },
+    { "access-control-max-age", 22 },
+    { "access-control-request-headers", 30 },
+    { "access-control-request-method", 29 },
+    { "age", 3 },
+    { "allow", 5 },
+    { "alt-svc", 7 },
+    { "authorization", 13 },
+    { "cache-control", 13 },
+    { "connection", 10 },
+    { "content-disposition", 19 },
+    { "content-encoding", 16 },
+    { "content-language", 16 },
+    { "content-length", 14 },
+    { "content-location", 16 },
+    { "content-range", 13 },
+    { "content-security-policy", 23 },
+    { "content-type", 12 },
+    { "cookie", 6 },
+    { "date", 4 },
+    { "etag", 4 },
+    { "expect", 6 },
+    { "expires", 7 },
+    { "forwarded", 9 },
+    { "from", 4 },
+    { "host", 4 },
+    { "if-match", 8 },
+    { "if-modified-since", 17 },
+    { "if-none-match", 13 },
+    { "if-range", 8 },
+    { "if-unmodified-since", 19 },
+    { "keep-alive", 10 },
+    { "last-modified", 13 },
+    { "link", 4 },
+    { "location", 8 },
+    { "max-forwards", 12 },
+    { "origin", 6 },
+    { "pragma", 6 },
+    { "proxy-authenticate", 18 },
+    { "proxy-authorization", 19 },
+    { "proxy-connection", 16 },
+    { "range", 5 },
+    { "referer", 7 },
+    { "refresh", 7 },
+    { "retry-after", 11 },
+    { "server", 6 },
+    { "set-cookie", 10 },
+    { "strict-transport-security", 25 },
+    { "te", 2 },
+    { "trailer", 7 },
+    { "transfer-encoding", 17 },
+    { "upgrade", 7 },
+    { "upgrade-insecure-requests", 25 },
+    { "user-agent", 10 },
+    { "vary", 4 },
+    { "via", 3 },
+    { "www-authenticate", 16 },
+    { "x-content-type-options", 22 },
+    { "x-forwarded-for", 15 },
+    { "x-forwarded-host", 16 },
+    { "x-forwarded-proto", 17 },
+    { "x-frame-options", 15 },
+    { "x-real-ip", 9 },
+    { "x-request-id", 12 },
+    { "x-requested-with", 16 },
+};
+
+// Hash seed for each bucket of the perfect hash function.
+static const unsigned int _seeds[16] = {
+    2, 2, 0, 1, 3, 0, 0, 1, 1, 1, 4, 4, 0, 1, 2, 3,
+};
+
+// Maps perfect hash values to token identifiers.
+static const unsigned char _tokens[256] = {
+    18,  0,  5, 74, 55, 61,  0,  7,  0,  0,  0,  0,  0, 13,  0,  0,
+     0,  0,  0,  0,  0,  0,  0,  2,  0,  0,  0,  0,  0,  0,  0,  0,
+     0,  3,  0, 39,  0,  0,  0,  0,  0, 47, 45,  0,  0,  0,  0,  0,
+     0,  0, 62,  0,  0, 42,  0,  4, 40,  0,  0,  0, 16, 35,  0, 26,
+     0,  0,  0,  0,  0,  0,  0,  0, 44, 64,  0,  0,  0,  0, 48,  0,
+     0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0,  0, 66,  0, 52,
+    67,  0,  0,  0, 19,  0, 71,  0,  0,  0,  0,  0,  0,  0, 24,  0,
+     0,  0,  0, 25, 50,  0,  8,  0,  0, 60,  0,  0,  0,  0,  0,  0,
+     0,  6,  0, 34,  0,  0,  0, 31, 21,  0,  0,  0,  0, 14,  0,  0,
+    33,  0, 54,  0,  0,  0,  0,  0,  0,  0, 57, 49,  0,  0, 11,  0,
+     0,  0,  0,  0,  0,  0,  0, 10,  0, 69, 43,  1,  0,  0,  0, 27,
+     0,  0,  0,  0,  9, 53,  0,  0, 28,  0, 58,  0,  0,  0,  0, 46,
+    15,  0,  0,  0,  0,  0,  0, 56, 12,  0, 38,  0,  0,  0,  0,  0,
+    65, 51,  0,  0, 29, 32,  0,  0,  0,  0,  0, 68, 23, 36, 41,  0,
+     0,  0, 20,  0,  0,  0,  0,  0, 37,  0,  0, 22, 63,  0,  0,  0,
+     0,  0,  0, 70,  0,  0, 73, 17, 30,  0,  0,  0, 72, 59,  0,  0,
+};
+
+static http_header _token (const char * field, size_t size)
+{
+    // Perfect hash, see the tables above.
+    unsigned int hash = (unsigned int)_hashn(field, size);
+    unsigned int slot = ((hash ^ _seeds[hash & 15]) * 0x9E3779B1u) >> 24;
+    http_header id = (http_header)_tokens[slot & 255];
+    if ((id == HTTP_HEADER_UNKNOWN) || (_names[id].size != size) ||
+        !_memieq(_names[id].data, field, size, 1)) {
+        return (HTTP_HEADER_UNKNOWN);
+    }
+    return (id);
+}
+
+// Canonical name for a token, as spelled by @a head.
+static const http_name * _canonical (const http_head * head, unsigned char id)
+{
+    if (id >= HTTP_HEADER_COUNT) {
+        id = HTTP_HEADER_UNKNOWN;
+    }
+    if ((head->options & HTTP_HEAD_LOWERCASE) != 0) {
+        return (&_lowercase[id]);
+    }
+    return (&_names[id]);
+}
+
+static const http_name * _expand (const http_head * head, const char * field)
+{
+    return (_canonical(head, (unsigned char)field[1]));
+}
+
+static const char * _field (const http_head * head, const char * field)
+{
+    return ((*field == CHTTP_TOKEN)? _expand(head, field)->data : field);
+}
+
+// Names are stored in lowercase in that mode, so only fold @a field.
+static int _same (const http_head * head, const char * name,
+                  const char * field, size_t size)
+{
+    return (_memieq(name, field, size,
+                    (head->options & HTTP_HEAD_LOWERCASE) == 0));
+}
+
+typedef struct http_slot
+{
+    // Hash of the (case-folded) header name.
+    size_t hash;
+    // Offset of the header name in the buffer, plus one (0 for empty slots).
+    size_t base;
+} http_slot;
+
+struct http_index
+{
+    // Number of slots, always a power of 2.
+    size_t size;
+    // Number of occupied slots.
+    size_t used;
+    // Buffer offset right past the last indexed header.
+    size_t edge;
+    // Open-addressed table, using linear probing.
+    http_slot slot[];
+};
+
+static size_t _index_size (size_t size)
+{
+    return (sizeof(struct http_index) + size*sizeof(http_slot));
+}
+
+static void _index_kill (http_head * self)
+{
+    if (self->index != 0) {
+        self->allocator->release(self->allocator->context,
+                                 self->index, _index_size(self->index->size));
+        self->index = 0;
+    }
+}
+
+static void _index_put (struct http_index * index, size_t hash, size_t base)
+{
+    size_t mask = index->size - 1;
+    size_t i = hash & mask;
+    // Equal names are probed in insertion order, so the first match found by
+    // a lookup is also the first in the buffer.
+    while (index->slot[i].base != 0) {
+        i = (i + 1) & mask;
+    }
+    index->slot[i].hash = hash;
+    index->slot[i].base = base + 1;
+    ++index->used;
+}
+
+static int _index_build (http_head * self, size_t size)
+{
+    http_cursor cursor;
+    size_t count = 0;
+    struct http_index * index = 0;
+    // Size the table to keep the load factor under 1/2.
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor)) {
+        ++count;
+    }
+    while (size < 2*(count+1)) {
+        size *= 2;
+    }
+    _index_kill(self);
+    index = self->allocator->acquire(self->allocator->context,
+                                     _index_size(size));
+    if ((self->index=index) == 0) {
+        return 0;
+    }
+    memset(index, 0, _index_size(size));
+    index->size = size;
+    // Index all headers in buffer order.
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor)) {
+        _index_put(index, _hash(cursor.field, &count), cursor.last);
+    }
+    index->edge = self->used;
+    return 1;
+}
+
+static void _index_add (http_head * self, size_t base)
+{
+    size_t size = 0;
+    struct http_index * index = self->index;
+    if (index == 0) {
+        return;
+    }
+    // Grow (or drop) the index when it gets too crowded.
+    if (2*(index->used+1) > index->size) {
+        _index_build(self, 2*index->size);
+        return;
+    }
+    _index_put(index, _hash(_field(self, self->data+base), &size), base);
+    index->edge = self->used;
+}
+
+// Locate the first header named @a field at or after offset @a from.
+static const char * _index_probe (const http_head * self, const char * field,
+                                  size_t size, size_t hash, size_t from)
+{
+    const struct http_index * index = self->index;
+    const http_name * name = 0;
+    size_t mask = index->size - 1;
+    size_t i = hash & mask;
+    size_t probes = 1;
+    for (; index->slot[i].base != 0; i = (i + 1) & mask, ++probes)
+    {
+        const size_t base = index->slot[i].base - 1;
+        const char * match = self->data + base;
+        if ((index->slot[i].hash != hash) || (base < from)) {
+            continue;
+        }
+        if (*match == CHTTP_TOKEN)
+        {
+            name = _expand(self, match);
+            if ((name->size == size) && _same(self, name->data, field, size)) {
+                CHTTP_COUNT(probes, probes);
+                return (match);
+            }
+        }
+        // Names shorter than @a field may sit right before the end.
+        else if (((base + size) < self->used) && (match[size] == '\0') &&
+                 _same(self, match, field, size)) {
+            CHTTP_COUNT(probes, probes);
+            return (match);
+        }
+    }
+    CHTTP_COUNT(probes, probes);
+    return (0);
+}
+
+static const char * _index_next (const http_head * self,
+                                 const char * field, size_t size, size_t from)
+{
+    return (_index_probe(self, field, size, _hashn(field, size), from));
+}
+
+// Header data for a match found in the index, or null.
+static const char * _index_data (const char * match, size_t size)
+{
+    if (match == 0) {
+        return (0);
+    }
+    return ((*match == CHTTP_TOKEN)? match + 3 : match + size + 1);
+}
+
+static const char * _index_find (const http_head * self,
+                                 const char * field, size_t size, size_t hash)
+{
+    const char * value =
+        _index_data(_index_probe(self, field, size, hash, 0), size);
+    CHTTP_COUNT(hits, (value != 0));
+    CHTTP_COUNT(misses, (value == 0));
+    return ((value == 0)? "" : value);
+}
+
+// Values produced by typed accessors.
+typedef union http_value
+{
+    unsigned long long u64;
+    time_t date;
+} http_value;
+
+// Parse @a size bytes at @a data, returning 0 if they are malformed.
+typedef int (*http_parse)(const char * data, size_t size, http_value * value);
+
+// Longer names are never cached.
+#define CHTTP_CACHE_NAME 32
+
+typedef struct http_entry
+{
+    // Parser that produced the value, null for free entries.
+    http_parse parse;
+    // Hash of the (case-folded) header name, and the name in lowercase.
+    size_t hash;
+    size_t size;
+    char field[CHTTP_CACHE_NAME];
+    // Result of the accessor, and the value, on success.
+    int status;
+    http_value value;
+} http_entry;
+
+struct http_cache
+{
+    // Next entry to replace, round robin.
+    size_t next;
+    http_entry entry[8];
+};
+
+#define CHTTP_CACHE_SIZE (sizeof(((struct http_cache*)0)->entry) / \
+                          sizeof(http_entry))
+
+static void _cache_kill (http_head * self)
+{
+    if (self->cache != 0) {
+        self->allocator->release(self->allocator->context,
+                                 self->cache, sizeof(struct http_cache));
+        self->cache = 0;
+    }
+}
+
+static void _cache_clear (http_head * self)
+{
+    if (self->cache != 0) {
+        memset(self->cache, 0, sizeof(struct http_cache));
+    }
+}
+
+// Drop entries for headers named like the one at offset @a base.
+static void _cache_drop (http_head * self, size_t base)
+{
+    size_t hash = 0;
+    size_t size = 0;
+    size_t i = 0;
+    if (self->cache == 0) {
+        return;
+    }
+    hash = _hash(_field(self, self->data+base), &size);
+    for (i = 0; i < CHTTP_CACHE_SIZE; ++i)
+    {
+        if ((self->cache->entry[i].hash == hash) &&
+            (self->cache->entry[i].size == size)) {
+            self->cache->entry[i].parse = 0;
+        }
+    }
+}
+
+static http_entry * _cache_find (const http_head * self, http_parse parse,
+                                 const char * field, size_t size, size_t hash)
+{
+    http_entry * entry = 0;
+    size_t i = 0;
+    if (self->cache == 0) {
+        return (0);
+    }
+    for (i = 0; i < CHTTP_CACHE_SIZE; ++i)
+    {
+        entry = &self->cache->entry[i];
+        if ((entry->parse == parse) && (entry->hash == hash) &&
+            (entry->size == size) && _memieq(entry->field, field, size, 0)) {
+            return (entry);
+        }
+    }
+    return (0);
+}
+
+static http_entry * _cache_add (http_head * self, http_parse parse,
+                                const char * field, size_t size, size_t hash)
+{
+    http_entry * entry = 0;
+    if (size >= CHTTP_CACHE_NAME) {
+        return (0);
+    }
+    if (self->cache == 0)
+    {
+        self->cache = self->allocator->acquire(self->allocator->context,
+                                               sizeof(struct http_cache));
+        if (self->cache == 0) {
+            return (0);
+        }
+        memset(self->cache, 0, sizeof(struct http_cache));
+    }
+    entry = &self->cache->entry[self->cache->next];
+    self->cache->next = (self->cache->next + 1) % CHTTP_CACHE_SIZE;
+    entry->parse = parse;
+    entry->hash = hash;
+    entry->size = size;
+    memcpy(entry->field, field, size), _lower(entry->field, size);
+    return (entry);
+}
+
+static void * _acquire (void * context, size_t size)
+{
+    return (malloc(size));
+}
+
+static void * _resize (void * context, void * data, size_t used, size_t size)
+{
+    return (realloc(data, size));
+}
+
+static void _release (void * context, void * data, size_t size)
+{
+    free(data);
+}
+
+// Used when the caller does not supply an allocator.
+static const http_allocator _default_allocator = {
+    _acquire, _resize, _release, 0
+};
+
+static int _reserve (http_head * self, size_t tail, size_t size)
+{
+    size_t need = 0;
+    size_t grow = 0;
+    char * data = 0;
+    // Check that enough space is remaining.
+    if ((self->size-self->used-tail) >= size) {
+        return 1;
+    }
+    if ((self->limit-self->used-tail) < size) {
+        CHTTP_FAIL(self, HTTP_STATS_OVERFLOW);
+        return 0;
+    }
+    // Grow geometrically, up to the limit.  Marks only hold offsets into the
+    // buffer, so they survive the move.
+    need = self->used + tail + size;
+    grow = (self->size < self->limit/2)? 2*self->size : self->limit;
+    grow = (grow < need)? need : grow;
+    // Caller-provided memory can't be resized, so leave it for the heap.
+    if (self->data == self->storage) {
+        data = self->allocator->acquire(self->allocator->context, grow);
+        if (data != 0) {
+            memcpy(data, self->data, self->used+1);
+        }
+    }
+    else {
+        data = self->allocator->resize(self->allocator->context,
+                                       self->data, self->used+1, grow);
+    }
+    if (data == 0) {
+        CHTTP_FAIL(self, HTTP_STATS_OVERFLOW);
+        return 0;
+    }
+    self->data = data, self->size = grow;
+    return 1;
+}
+
+int http_head_init (http_head * self, size_t size)
+{
+    return (http_head_init_ex(self, size, size, 0));
+}
+
+int http_head_init_ex (http_head * self, size_t size, size_t limit,
+                       const http_allocator * allocator)
+{
+    self->allocator = (allocator == 0)? &_default_allocator : allocator;
+    self->limit = (limit < size)? size : limit;
+    self->data = self->allocator->acquire(self->allocator->context, size);
+    self->size = size, self->used = 0;
+    self->dead = 0;
+    self->index = 0;
+    self->cache = 0;
+    self->storage = 0;
+    self->options = 0;
+    if ((self->data != 0) && (size > 0)) {
+        self->data[0] = '\0';
+    }
+    return (self->data != 0);
+}
+
+int http_head_init_storage (http_head * self, char * data, size_t size,
+                            size_t limit, const http_allocator * allocator)
+{
+    if (size == 0) {
+        return 0;
+    }
+    self->allocator = (allocator == 0)? &_default_allocator : allocator;
+    self->limit = (limit < size)? size : limit;
+    self->data = self->storage = data;
+    self->size = size, self->used = 0;
+    self->dead = 0;
+    self->index = 0;
+    self->cache = 0;
+    self->options = 0;
+    self->data[0] = '\0';
+    return 1;
+}
+
+void http_head_kill (http_head * self)
+{
+    _index_kill(self);
+    _cache_kill(self);
+    if ((self->data != 0) && (self->data != self->storage)) {
+        self->allocator->release(self->allocator->context,
+                                 self->data, self->size);
+    }
+    self->data = self->storage = 0;
+    self->used = self->size = self->limit = 0;
+    self->dead = 0;
+}
+
+// Memory that holds the headers and can leave @a self, or null.
+static char * _detach (http_head * self)
+{
+    char * data = self->data;
+    // Caller-provided memory stays behind, so copy the headers out of it.
+    if ((data != 0) && (data == self->storage)) {
+        data = self->allocator->acquire(self->allocator->context, self->size);
+        if (data != 0) {
+            memcpy(data, self->storage, self->used+1);
+        }
+    }
+    return (data);
+}
+
+// Forget the memory after it moved elsewhere.
+static void _forget (http_head * self)
+{
+    self->data = self->storage = 0;
+    self->index = 0;
+    self->cache = 0;
+    self->used = self->size = self->limit = 0;
+    self->dead = 0;
+}
+
+int http_head_move (http_head * self, http_head * other)
+{
+    char * data = _detach(other);
+    if ((data == 0) && (other->data != 0)) {
+        return 0;
+    }
+    *self = *other;
+    self->data = data;
+    self->storage = 0;
+    _forget(other);
+    return 1;
+}
+
+int http_head_adopt (http_head * self, char * data, size_t size, size_t used,
+                     size_t limit, const http_allocator * allocator)
+{
+    size_t base = 0;
+    size_t span = 0;
+    size_t dead = 0;
+    if ((data == 0) || (used >= size) || (data[used] != '\0')) {
+        return 0;
+    }
+    // Each header needs a non-empty name and a value, both terminated.
+    while (base < used)
+    {
+        span = next_segment(data+base, used-base) + 1;
+        if ((span == 1) || ((base + span) >= used)) {
+            return 0;
+        }
+        span += next_segment(data+base+span, used-base-span) + 1;
+        if ((base + span) > used) {
+            return 0;
+        }
+        if (data[base] == CHTTP_DEAD) {
+            dead += span;
+        }
+        base += span;
+    }
+    self->allocator = (allocator == 0)? &_default_allocator : allocator;
+    self->limit = (limit < size)? size : limit;
+    self->data = data;
+    self->size = size, self->used = used;
+    self->dead = dead;
+    self->index = 0;
+    self->cache = 0;
+    self->storage = 0;
+    self->options = 0;
+    return 1;
+}
+
+char * http_head_release (http_head * self, size_t * size, size_t * used)
+{
+    char * data = _detach(self);
+    if (data == 0) {
+        return (0);
+    }
+    *size = self->size;
+    *used = self->used;
+    _index_kill(self);
+    _cache_kill(self);
+    _forget(self);
+    return (data);
+}
+
+void http_head_reset (http_head * self)
+{
+    struct http_index * index = self->index;
+    self->used = self->dead = 0;
+    if (self->size > 0) {
+        self->data[0] = '\0';
+    }
+    if (index != 0) {
+        memset(index->slot, 0, index->size*sizeof(http_slot));
+        index->used = index->edge = 0;
+    }
+    _cache_clear(self);
+}
+
+// Slabs and free buffers are chained through their first bytes.
+typedef union http_link
+{
+    union http_link * next;
+    // Keeps buffers suitably aligned.
+    long double align;
+} http_link;
+
+static void * _pool_acquire (void * context, size_t size)
+{
+    http_pool * pool = context;
+    http_link * slab = 0;
+    char * data = 0;
+    size_t i = 0;
+    // Memory that doesn't fit in a slab comes from the heap.
+    if (size > pool->size) {
+        return (malloc(size));
+    }
+    // Carve a new slab when we run out of buffers.
+    if (pool->free == 0)
+    {
+        slab = malloc(sizeof(http_link) + pool->count*pool->size);
+        if (slab == 0) {
+            return (0);
+        }
+        slab->next = pool->slabs, pool->slabs = slab;
+        data = (char*)(slab + 1);
+        for (i = 0; i < pool->count; ++i, data += pool->size) {
+            ((http_link*)data)->next = pool->free, pool->free = data;
+        }
+    }
+    data = pool->free, pool->free = ((http_link*)data)->next;
+    return (data);
+}
+
+static void _pool_release (void * context, void * data, size_t size)
+{
+    http_pool * pool = context;
+    if (size > pool->size) {
+        free(data);
+    }
+    else if (data != 0) {
+        ((http_link*)data)->next = pool->free, pool->free = data;
+    }
+}
+
+static void * _pool_resize (void * context, void * data,
+                            size_t used, size_t size)
+{
+    http_pool * pool = context;
+    // Pooled heads have a fixed capacity: slab buffers never move, and no
+    // block is ever too large for a slab.
+    if (size > pool->size) {
+        return (0);
+    }
+    return ((data != 0)? data : _pool_acquire(context, size));
+}
+
+void http_pool_init (http_pool * self, size_t size, size_t count)
+{
+    // Buffers need to hold at least a link, and remain aligned.
+    size = (size < sizeof(http_link))? sizeof(http_link) : size;
+    size = (size + sizeof(http_link)-1) / sizeof(http_link) * sizeof(http_link);
+    self->allocator.acquire = _pool_acquire;
+    self->allocator.resize = _pool_resize;
+    self->allocator.release = _pool_release;
+    self->allocator.context = self;
+    self->size = size;
+    self->count = (count == 0)? 1 : count;
+    self->free = self->slabs = 0;
+}
+
+void http_pool_kill (http_pool * self)
+{
+    http_link * slab = self->slabs;
+    while (slab != 0) {
+        self->slabs = slab->next, free(slab), slab = self->slabs;
+    }
+    self->free = 0;
+}
+
+int http_head_pool_acquire (http_head * self, http_pool * pool)
+{
+    return (http_head_init_ex(self, pool->size, pool->size, &pool->allocator));
+}
+
+void http_head_pool_release (http_head * self)
+{
+    http_head_kill(self);
+}
+
+int http_head_push (http_head * self, const char * field, const char * value)
+{
+    http_mark mark;
+    if (!http_head_mark(self, &mark)) {
+        return 0;
+    }
+    if (!http_head_push_field(&mark, field, strlen(field))) {
+        http_head_cancel(&mark);
+        return 0;
+    }
+    if (!http_head_push_value(&mark, value, strlen(value))) {
+        http_head_cancel(&mark);
+        return 0;
+    }
+    if (!http_head_commit(&mark)) {
+        http_head_cancel(&mark);
+        return 0;
+    }
+    return 1;
+}
+
+const char * http_head_find (const http_head * self, const char * field)
+{
+    return (http_head_findn(self, field, strlen(field)));
+}
+
+// Compare names of the right length, in buffer order.
+static const char * _search (const http_head * self,
+                             const char * field, size_t size)
+{
+    http_cursor cursor;
+    size_t probes = 0;
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor))
+    {
+        ++probes;
+        if ((cursor.field_size == size) &&
+            _same(self, cursor.field, field, size)) {
+            CHTTP_COUNT(probes, probes), CHTTP_COUNT(hits, 1);
+            return (cursor.value);
+        }
+    }
+    CHTTP_COUNT(probes, probes), CHTTP_COUNT(misses, 1);
+    return ("");
+}
+
+const char * http_head_findn (const http_head * self,
+                              const char * field, size_t size)
+{
+    if (self->index != 0) {
+        return (_index_find(self, field, size, _hashn(field, size)));
+    }
+    return (_search(self, field, size));
+}
+
+const char * http_head_find_hashed (const http_head * self,
+                                    const char * field, size_t size,
+                                    unsigned int hash)
+{
+    if (self->index != 0) {
+        return (_index_find(self, field, size, hash));
+    }
+    return (_search(self, field, size));
+}
+
+unsigned int http_header_hash (const char * field, size_t size)
+{
+    return ((unsigned int)_hashn(field, size));
+}
+
+const char * http_head_find_id (const http_head * self, http_header id)
+{
+    const http_name * name = 0;
+    http_cursor cursor;
+    size_t probes = 0;
+    if ((id <= HTTP_HEADER_UNKNOWN) || (id >= HTTP_HEADER_COUNT)) {
+        CHTTP_COUNT(misses, 1);
+        return ("");
+    }
+    name = _canonical(self, (unsigned char)id);
+    if (self->index != 0) {
+        return (_index_find(self, name->data, name->size,
+                            _hashn(name->data, name->size)));
+    }
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor))
+    {
+        ++probes;
+        // Tokens expand to the canonical name, so compare pointers first.
+        if ((cursor.field == name->data) ||
+            ((cursor.field_size == name->size) &&
+             _same(self, cursor.field, name->data, name->size))) {
+            CHTTP_COUNT(probes, probes), CHTTP_COUNT(hits, 1);
+            return (cursor.value);
+        }
+    }
+    CHTTP_COUNT(probes, probes), CHTTP_COUNT(misses, 1);
+    return ("");
+}
+
+// Replace missing values by empty strings and count the others.
+static size_t _found (const char ** values, size_t count)
+{
+    size_t found = 0;
+    size_t i = 0;
+    for (i = 0; i < count; ++i) {
+        if (values[i] == 0) {
+            values[i] = "";
+        }
+        else {
+            ++found;
+        }
+    }
+    return (found);
+}
+
+size_t http_head_find_many (const http_head * self,
+                            const char * const * fields, size_t count,
+                            const char ** values)
+{
+    http_cursor cursor;
+    size_t found = 0;
+    size_t size = 0;
+    size_t i = 0;
+    for (i = 0; i < count; ++i) {
+        values[i] = 0;
+    }
+    // The index beats a scan, even for many names.
+    if (self->index != 0) {
+        for (i = 0; i < count; ++i) {
+            size = strlen(fields[i]);
+            values[i] = _index_data(_index_next(self, fields[i], size, 0),
+                                    size);
+        }
+        return (_found(values, count));
+    }
+    // Scan once, stopping when all names have been found.
+    http_cursor_init(&cursor, self);
+    while ((found < count) && http_cursor_next(&cursor))
+    {
+        for (i = 0; i < count; ++i)
+        {
+            if ((values[i] == 0) &&
+                _strnieq(cursor.field, fields[i], cursor.field_size) &&
+                (fields[i][cursor.field_size] == '\0')) {
+                values[i] = cursor.value, ++found;
+            }
+        }
+    }
+    return (_found(values, count));
+}
+
+// Precomputed name hash, in a lookup set.
+struct http_lookup_slot
+{
+    size_t hash;
+    size_t size;
+    // Position in the set, plus one (0 for empty slots).
+    size_t index;
+};
+
+int http_lookup_init (http_lookup * self,
+                      const char * const * fields, size_t count)
+{
+    size_t size = 8;
+    size_t hash = 0;
+    size_t length = 0;
+    size_t i = 0;
+    size_t j = 0;
+    // Keep the load factor under 1/2.
+    while (size < 2*count) {
+        size *= 2;
+    }
+    self->slots = calloc(size, sizeof(struct http_lookup_slot));
+    if (self->slots == 0) {
+        return 0;
+    }
+    self->fields = fields;
+    self->count = count;
+    self->size = size;
+    for (i = 0; i < count; ++i)
+    {
+        hash = _hash(fields[i], &length);
+        for (j = hash & (size-1); self->slots[j].index != 0;) {
+            j = (j + 1) & (size-1);
+        }
+        self->slots[j].hash = hash;
+        self->slots[j].size = length;
+        self->slots[j].index = i + 1;
+    }
+    return 1;
+}
+
+void http_lookup_kill (http_lookup * self)
+{
+    free(self->slots);
+    self->slots = 0;
+    self->count = self->size = 0;
+}
+
+size_t http_head_lookup (const http_head * self, const http_lookup * lookup,
+                         const char ** values)
+{
+    const struct http_lookup_slot * slot = 0;
+    const size_t mask = lookup->size - 1;
+    http_cursor cursor;
+    size_t found = 0;
+    size_t hash = 0;
+    size_t i = 0;
+    for (i = 0; i < lookup->count; ++i) {
+        values[i] = 0;
+    }
+    // Probe the index with the precomputed hashes.
+    if (self->index != 0)
+    {
+        for (i = 0; i < lookup->size; ++i)
+        {
+            slot = &lookup->slots[i];
+            if (slot->index != 0) {
+                values[slot->index-1] = _index_data(_index_probe(self,
+                    lookup->fields[slot->index-1], slot->size, slot->hash, 0),
+                    slot->size);
+            }
+        }
+        return (_found(values, lookup->count));
+    }
+    // Scan once, hashing each name to find it in the set.
+    http_cursor_init(&cursor, self);
+    while ((found < lookup->count) && http_cursor_next(&cursor))
+    {
+        hash = _hashn(cursor.field, cursor.field_size);
+        for (i = hash & mask; lookup->slots[i].index != 0; i = (i+1) & mask)
+        {
+            slot = &lookup->slots[i];
+            if ((slot->hash == hash) && (slot->size == cursor.field_size) &&
+                (values[slot->index-1] == 0) && _same(self, cursor.field,
+                    lookup->fields[slot->index-1], slot->size)) {
+                values[slot->index-1] = cursor.value, ++found;
+            }
+        }
+    }
+    return (_found(values, lookup->count));
+}
+
+http_header http_header_id (const char * field, size_t size)
+{
+    if ((size < 2) || (size > 32)) {
+        return (HTTP_HEADER_UNKNOWN);
+    }
+    return (_token(field, size));
+}
+
+const char * http_header_name (http_header id)
+{
+    if ((id < HTTP_HEADER_UNKNOWN) || (id >= HTTP_HEADER_COUNT)) {
+        id = HTTP_HEADER_UNKNOWN;
+    }
+    return (_names[id].data);
+}
+
+void http_head_configure (http_head * self, unsigned int options)
+{
+    http_cursor cursor;
+    char * name = 0;
+    // Later lookups rely on names being in lowercase in that mode.
+    if (((options & ~self->options) & HTTP_HEAD_LOWERCASE) != 0)
+    {
+        http_cursor_init(&cursor, self);
+        while (http_cursor_next(&cursor))
+        {
+            name = self->data + cursor.last;
+            if (*name != CHTTP_TOKEN) {
+                _lower(name, cursor.field_size);
+            }
+        }
+    }
+    self->options = options;
+}
+
+size_t http_head_iovec_size (const http_head * self)
+{
+    http_cursor cursor;
+    size_t size = 0;
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor)) {
+        size += 4;
+    }
+    return (size);
+}
+
+#if !defined(_WIN32)
+size_t http_head_to_iovec (const http_head * self,
+                           struct iovec * iov, size_t size)
+{
+    static const char colon[] = ": ";
+    static const char crlf[] = "\r\n";
+    http_cursor cursor;
+    size_t used = 0;
+    http_cursor_init(&cursor, self);
+    for (; http_cursor_next(&cursor); used += 4)
+    {
+        if ((size-used) < 4) {
+            return (0);
+        }
+        // Writers never modify the data, so dropping const is safe.
+        iov[used+0].iov_base = (void*)cursor.field;
+        iov[used+0].iov_len = cursor.field_size;
+        iov[used+1].iov_base = (void*)colon;
+        iov[used+1].iov_len = sizeof(colon)-1;
+        iov[used+2].iov_base = (void*)cursor.value;
+        iov[used+2].iov_len = cursor.value_size;
+        iov[used+3].iov_base = (void*)crlf;
+        iov[used+3].iov_len = sizeof(crlf)-1;
+    }
+    return (used);
+}
+#endif
+
+int http_head_index (http_head * self)
+{
+    if (self->index != 0) {
+        return 1;
+    }
+    return (_index_build(self, 16));
+}
+
+int http_head_mark (http_head * self, http_mark * mark)
+{
+    if (!_reserve(self, 0, 4)) {
+        memset(mark, 0, sizeof(http_mark));
+        return 0;
+    }
+    mark->head = self;
+    mark->base = self->used;
+    mark->field_end = mark->value_base = self->used;
+    mark->mode = 0;
+    return (1);
+}
+
+static void _append (http_head * self, const char * data, size_t size)
+{
+    // Stop at the first null character, then copy in bulk.
+    if (size > 0) {
+        size = next_segment(data, size);
+        memcpy(self->data+self->used, data, size), self->used += size;
+    }
+    // Add null terminator.
+    self->data[self->used] = '\0';
+}
+
+static int _push_field (http_head * self, const char * field, size_t size)
+{
+    const size_t used = self->used;
+    // Check that enough space is remaining.
+    if (!_reserve(self, 3, size)) {
+        return 0;
+    }
+    _append(self, field, size);
+    if ((self->options & HTTP_HEAD_LOWERCASE) != 0) {
+        _lower(self->data+used, self->used-used);
+    }
+    CHTTP_COUNT(pushes, 1);
+    CHTTP_COUNT(bytes, self->used-used);
+    return 1;
+}
+
+int http_head_push_field (http_mark * self, const char * field, size_t size)
+{
+    // Make sure we're still inserting a header name.
+    if (self->mode != 0) {
+        CHTTP_FAIL(self->head, HTTP_STATS_REJECT);
+        return 0;
+    }
+    return (_push_field(self->head, field, size));
+}
+
+static int _push_value (http_head * self, const char * value, size_t size)
+{
+    const size_t used = self->used;
+    // Check that enough space is remaining.
+    if (!_reserve(self, 2, size)) {
+        return 0;
+    }
+    _append(self, value, size);
+    CHTTP_COUNT(pushes, 1);
+    CHTTP_COUNT(bytes, self->used-used);
+    return 1;
+}
+
+static void _tokenize (http_head * self, size_t base)
+{
+    http_header id = http_header_id(self->data+base, self->used-base);
+    if (id != HTTP_HEADER_UNKNOWN) {
+        self->data[base+0] = CHTTP_TOKEN;
+        self->data[base+1] = (char)id;
+        self->data[self->used=base+2] = '\0';
+    }
+}
+
+static int _switch (http_mark * self)
+{
+    http_head * head = self->head;
+    // Disallow empty names.
+    if (head->used == self->base) {
+        CHTTP_FAIL(head, HTTP_STATS_REJECT);
+        return 0;
+    }
+    // Control characters are reserved for tokens.
+    if ((unsigned char)head->data[self->base] < 0x20) {
+        CHTTP_FAIL(head, HTTP_STATS_REJECT);
+        return 0;
+    }
+    if ((head->options & HTTP_HEAD_TOKENS) != 0) {
+        _tokenize(head, self->base);
+    }
+    // Skip the field's null terminator and start an empty value.
+    self->field_end = head->used++;
+    self->value_base = head->used;
+    head->data[head->used] = '\0';
+    self->mode = 1;
+    return 1;
+}
+
+int http_head_push_value (http_mark * self, const char * field, size_t size)
+{
+    // Swich to value if necessary.
+    if ((self->mode == 0) && !_switch(self)) {
+        return 0;
+    }
+    // Make sure we're still inserting header data.
+    if (self->mode != 1) {
+        CHTTP_FAIL(self->head, HTTP_STATS_REJECT);
+        return 0;
+    }
+    return (_push_value(self->head, field, size));
+}
+
+static int _commit (http_head * self, const http_mark * mark)
+{
+    // Validate the mark.
+    if (mark->base >= (self->size-3)) {
+        CHTTP_FAIL(self, HTTP_STATS_REJECT);
+        return 0;
+    }
+    // Verify that the partial operations put valid null terminators.  Since
+    // pushes never copy null characters, checking the segment boundaries we
+    // tracked along the way is enough.
+    if ((mark->field_end <= mark->base) ||
+        (mark->value_base != mark->field_end+1) ||
+        (mark->value_base > self->used) ||
+        (self->data[mark->field_end] != '\0') ||
+        (self->data[self->used] != '\0')) {
+        CHTTP_FAIL(self, HTTP_STATS_REJECT);
+        return 0;
+    }
+    // Restore buffer invariant.
+    self->data[++self->used] = '\0';
+    _index_add(self, mark->base);
+    _cache_drop(self, mark->base);
+    CHTTP_COUNT(commits, 1);
+    CHTTP_PEAK(peak_used, self->used);
+    CHTTP_PEAK(peak_fill, (unsigned long long)self->used*1000 / self->size);
+    return 1;
+}
+
+int http_head_commit (http_mark * self)
+{
+    // Allow empty values.
+    if ((self->mode == 0) && !_switch(self)) {
+        return 0;
+    }
+    // Make sure we're still inserting header data.
+    if (self->mode != 1) {
+        CHTTP_FAIL(self->head, HTTP_STATS_REJECT);
+        return 0;
+    }
+    return (_commit(self->head, self));
+}
+
+static int _cancel (http_head * self, size_t mark)
+{
+    // Validate the mark.
+    if ((mark >= (self->size-3))) {
+        CHTTP_FAIL(self, HTTP_STATS_REJECT);
+        return 0;
+    }
+    CHTTP_COUNT(cancels, 1);
+    // Restore buffer invariants.
+    self->data[self->used=mark] = '\0';
+    // Drop index entries for headers we just rolled back.
+    if ((self->index != 0) && (mark < self->index->edge)) {
+        _index_build(self, 16);
+    }
+    _cache_clear(self);
+    return 1;
+}
+
+int http_head_cancel (http_mark * self)
+{
+    return (_cancel(self->head, self->base));
+}
+
+void http_cursor_init (http_cursor * self, const http_head * head)
+{
+    self->head = head;
+    self->base = self->last = 0;
+    self->field = self->value = 0;
+    self->field_size = self->value_size = 0;
+}
+
+// Offset of the first live header at or after @a base.
+static size_t _skip (const http_head * self, size_t base)
+{
+    while (self->data[base] == CHTTP_DEAD)
+    {
+        base += next_segment(self->data+base, self->used-base) + 1;
+        base += next_segment(self->data+base, self->used-base) + 1;
+    }
+    return (base);
+}
+
+int http_cursor_next (http_cursor * self)
+{
+    const char * text = 0;
+    size_t size = 0;
+    size_t span = 0;
+    self->base = self->last = _skip(self->head, self->base);
+    text = self->head->data + self->base;
+    size = self->head->used - self->base;
+    // Guard against empty head & extra iterations.
+    if (*text == '\0') {
+        self->field = self->value = "";
+        self->field_size = self->value_size = 0;
+        return (0);
+    }
+    self->field = text;
+    self->field_size = span = next_segment(text, size);
+    // Expose the canonical name for tokens.
+    if (*text == CHTTP_TOKEN) {
+        self->field = _expand(self->head, text)->data;
+        self->field_size = _expand(self->head, text)->size;
+    }
+    text += span + 1, size -= span + 1;
+    self->value = text;
+    self->value_size = next_segment(text, size);
+    self->base += span + self->value_size + 2;
+    return (1);
+}
+
+int http_cursor_find (http_cursor * self, const char * field, size_t size)
+{
+    const char * match = 0;
+    // Jump straight to the next match, if any.
+    if (self->head->index != 0) {
+        match = _index_next(self->head, field, size, self->base);
+        self->base = (match == 0)? self->head->used :
+            (size_t)(match - self->head->data);
+        return (http_cursor_next(self));
+    }
+    while (http_cursor_next(self))
+    {
+        if ((self->field_size == size) &&
+            _same(self->head, self->field, field, size)) {
+            return (1);
+        }
+    }
+    return (0);
+}
+
+static void _copy (char * data, size_t capacity, size_t used,
+                   const char * text, size_t size)
+{
+    // Copy what fits, leaving room for the null terminator.
+    if ((used + 1) < capacity) {
+        memcpy(data+used, text,
+               ((used+size) < capacity)? size : capacity-used-1);
+    }
+}
+
+size_t http_head_coalesce (const http_head * self, const char * field,
+                           size_t size, char * data, size_t capacity)
 {
+    http_cursor cursor;
     size_t used = 0;
-    while (**segment != '\0') {
-        ++*segment, ++used;
+    int count = 0;
+    http_cursor_init(&cursor, self);
+    while (http_cursor_find(&cursor, field, size))
+    {
+        if (count++ > 0) {
+            _copy(data, capacity, used, ", ", 2), used += 2;
+        }
+        _copy(data, capacity, used, cursor.value, cursor.value_size);
+        used += cursor.value_size;
+    }
+    if (capacity > 0) {
+        data[(used < capacity)? used : capacity-1] = '\0';
     }
-    ++*segment, ++used;
     return (used);
 }
 
-int http_head_init (http_head * self, size_t size)
+// Parse a (non-empty) sequence of digits.
+static int _parse_u64 (const char * data, size_t size, http_value * value)
 {
-    self->data = malloc(self->size=size), self->used = 0;
-    return (self->data != 0);
+    unsigned long long total = 0;
+    unsigned int digit = 0;
+    size_t i = 0;
+    if (size == 0) {
+        return 0;
+    }
+    for (i = 0; i < size; ++i)
+    {
+        digit = (unsigned int)(unsigned char)data[i] - '0';
+        if ((digit > 9) || (total > (ULLONG_MAX - digit) / 10)) {
+            return 0;
+        }
+        total = total*10 + digit;
+    }
+    value->u64 = total;
+    return 1;
 }
 
-void http_head_kill (http_head * self)
+// Parse exactly @a count digits.
+static int _digits (const char * data, int count, int * value)
+{
+    *value = 0;
+    for (; count > 0; --count, ++data)
+    {
+        if ((*data < '0') || (*data > '9')) {
+            return 0;
+        }
+        *value = *value*10 + (*data - '0');
+    }
+    return 1;
+}
+
+static int _month (const char * data, int * month)
 {
-    free(self->data), self->data = 0, self->used = self->size = 0;
+    static const char months[] = "JanFebMarAprMayJunJulAugSepOctNovDec";
+    for (*month = 1; *month <= 12; ++*month)
+    {
+        if (memcmp(data, months+3*(*month-1), 3) == 0) {
+            return 1;
+        }
+    }
+    return 0;
 }
 
-int http_head_push (http_head * self, const char * field, const char * value)
+// Parse "hh:mm:ss" as a number of seconds.
+static int _clock (const char * data, int * value)
 {
-    http_mark mark;
-    if (!http_head_mark(self, &mark)) {
+    int hour = 0;
+    int minute = 0;
+    int second = 0;
+    if (!_digits(data, 2, &hour) || (data[2] != ':') ||
+        !_digits(data+3, 2, &minute) || (data[5] != ':') ||
+        !_digits(data+6, 2, &second)) {
         return 0;
     }
-    if (!http_head_push_field(&mark, field, strlen(field))) {
-        http_head_cancel(&mark);
+    // Allow for leap seconds.
+    if ((hour > 23) || (minute > 59) || (second > 60)) {
         return 0;
     }
-    if (!http_head_push_value(&mark, value, strlen(value))) {
-        http_head_cancel(&mark);
-        return 0;
+    *value = hour*3600 + minute*60 + second;
+    return 1;
+}
+
+// Days since 1970-01-01, in the proleptic Gregorian calendar.
+static long long _days (long long year, int month, int day)
+{
+    long long era = 0;
+    long long days = 0;
+    // Count from March, so leap days end the year.
+    year -= (month <= 2);
+    era = ((year >= 0)? year : year-399) / 400;
+    days = (153*(month + ((month > 2)? -3 : 9)) + 2)/5 + day-1;
+    days += (year - era*400)*365 + (year - era*400)/4 - (year - era*400)/100;
+    return (era*146097 + days - 719468);
+}
+
+// Number of days in @a month of @a year, in the Gregorian calendar.
+static int _month_days (int year, int month)
+{
+    static const int days[12] = {31,28,31,30,31,30,31,31,30,31,30,31};
+    const int leap = ((year % 4) == 0) &&
+        (((year % 100) != 0) || ((year % 400) == 0));
+    return (days[month-1] + ((month == 2) && leap));
+}
+
+static int _parse_date (const char * data, size_t size, http_value * value)
+{
+    const char * comma = memchr(data, ',', size);
+    int day = 0;
+    int month = 0;
+    int year = 0;
+    int clock = 0;
+    int valid = 0;
+    if ((comma == data+3) && (size == 29)) {
+        // IMF-fixdate: "Sun, 06 Nov 1994 08:49:37 GMT".
+        valid = (data[4] == ' ') && _digits(data+5, 2, &day) &&
+            (data[7] == ' ') && _month(data+8, &month) &&
+            (data[11] == ' ') && _digits(data+12, 4, &year) &&
+            (data[16] == ' ') && _clock(data+17, &clock) &&
+            (memcmp(data+25, " GMT", 4) == 0);
     }
-    if (!http_head_commit(&mark)) {
-        http_head_cancel(&mark);
+    else if ((comma != 0) && ((size_t)(data+size - comma) == 24)) {
+        // RFC 850: "Sunday, 06-Nov-94 08:49:37 GMT".
+        data = comma + 2;
+        valid = (comma[1] == ' ') && _digits(data, 2, &day) &&
+            (data[2] == '-') && _month(data+3, &month) &&
+            (data[6] == '-') && _digits(data+7, 2, &year) &&
+            (data[9] == ' ') && _clock(data+10, &clock) &&
+            (memcmp(data+18, " GMT", 4) == 0);
+        year += (year < 70)? 2000 : 1900;
+    }
+    else if ((comma == 0) && (size == 24)) {
+        // asctime(): "Sun Nov  6 08:49:37 1994".
+        valid = (data[3] == ' ') && _month(data+4, &month) &&
+            (data[7] == ' ') && ((data[8] == ' ')?
+                _digits(data+9, 1, &day) : _digits(data+8, 2, &day)) &&
+            (data[10] == ' ') && _clock(data+11, &clock) &&
+            (data[19] == ' ') && _digits(data+20, 4, &year);
+    }
+    if (!valid || (day < 1) || (day > _month_days(year, month))) {
         return 0;
     }
+    value->date = (time_t)(_days(year, month, day)*86400 + clock);
     return 1;
 }
 
-const char * http_head_find (const http_head * self, const char * field)
+static int _get (http_head * self, http_parse parse,
+                 const char * field, size_t size, http_value * value)
 {
+    const size_t hash = _hashn(field, size);
+    http_entry * entry = _cache_find(self, parse, field, size, hash);
+    http_entry local;
     http_cursor cursor;
-    http_cursor_init(&cursor, self);
-    while (http_cursor_next(&cursor))
+    if (entry == 0)
     {
-        if (stricmp(cursor.field, field) == 0) {
-            return (cursor.value);
+        // Parse anyway when the result can't be cached.
+        entry = _cache_add(self, parse, field, size, hash);
+        if (entry == 0) {
+            entry = &local;
         }
+        http_cursor_init(&cursor, self);
+        entry->status = !http_cursor_find(&cursor, field, size)? 0 :
+            parse(cursor.value, cursor.value_size, &entry->value)? 1 : -1;
     }
-    return ("");
+    if (entry->status > 0) {
+        *value = entry->value;
+    }
+    return (entry->status);
 }
 
-int http_head_mark (http_head * self, http_mark * mark)
+int http_head_get_u64 (http_head * self, const char * field, size_t size,
+                       unsigned long long * value)
 {
-    if ((self->size-self->used) < 4) {
-        memset(mark, 0, sizeof(http_mark));
-        return 0;
+    http_value result;
+    const int status = _get(self, _parse_u64, field, size, &result);
+    if (status > 0) {
+        *value = result.u64;
     }
-    mark->head = self;
-    mark->base = self->used;
-    mark->mode = 0;
-    return (1);
+    return (status);
 }
 
-static int _push_field (http_head * self, const char * field, size_t size)
+int http_head_get_date (http_head * self, const char * field, size_t size,
+                        time_t * value)
 {
-    size_t used = 0;
-    // Check that enough space is remaining.
-    if ((self->size-self->used-3) < size) {
+    http_value result;
+    const int status = _get(self, _parse_date, field, size, &result);
+    if (status > 0) {
+        *value = result.date;
+    }
+    return (status);
+}
+
+static void _kill (http_head * self, const http_cursor * cursor)
+{
+    const size_t stop = (size_t)(cursor->value - self->data) +
+        cursor->value_size + 1;
+    self->data[cursor->last] = CHTTP_DEAD;
+    self->dead += stop - cursor->last;
+}
+
+static void _trim (http_head * self)
+{
+    // Amortize compaction over the removals that produced the dead bytes.
+    if ((2 * self->dead) > self->used) {
+        http_head_compact(self);
+    }
+}
+
+static int _push_header (http_head * self, const char * field, size_t size,
+                         const char * value, size_t value_size)
+{
+    http_mark mark;
+    if (!http_head_mark(self, &mark)) {
         return 0;
     }
-    // Copy data.
-    while ((used < size) && (field[used] != '\0')) {
-        self->data[self->used++] = field[used++];
+    if (!http_head_push_field(&mark, field, size) ||
+        !http_head_push_value(&mark, value, value_size) ||
+        !http_head_commit(&mark)) {
+        http_head_cancel(&mark);
+        return 0;
     }
-    // Add null terminator.
-    self->data[self->used] = '\0';
     return 1;
 }
 
-int http_head_push_field (http_mark * self, const char * field, size_t size)
+size_t http_head_remove (http_head * self, const char * field, size_t size)
 {
-    // Make sure we're still inserting a header name.
-    if (self->mode != 0) {
+    http_cursor cursor;
+    size_t count = 0;
+    http_cursor_init(&cursor, self);
+    while (http_cursor_find(&cursor, field, size)) {
+        _kill(self, &cursor), ++count;
+    }
+    if (count > 0) {
+        _cache_clear(self);
+    }
+    _trim(self);
+    return (count);
+}
+
+int http_head_replace (http_head * self, const char * field, size_t size,
+                       const char * value, size_t value_size)
+{
+    http_cursor cursor;
+    char * data = 0;
+    size_t room = 0;
+    size_t base = self->used;
+    // Reject invalid names up front, since they would fail after removal.
+    if ((size == 0) || ((unsigned char)*field < 0x20)) {
         return 0;
     }
-    return (_push_field(self->head, field, size));
+    value_size = (value_size > 0)? next_segment(value, value_size) : 0;
+    http_cursor_init(&cursor, self);
+    if (!http_cursor_find(&cursor, field, size)) {
+        return (_push_header(self, field, size, value, value_size));
+    }
+    // Overwrite the data in place when it fits, turning any leftover bytes
+    // into a dead header: a marker, filler and two null terminators.
+    if ((value_size == cursor.value_size) ||
+        ((value_size + 3) <= cursor.value_size))
+    {
+        data = self->data + (cursor.value - self->data);
+        room = cursor.value_size - value_size;
+        memcpy(data, value, value_size);
+        data[value_size] = '\0';
+        if (room > 0) {
+            data[value_size+1] = CHTTP_DEAD;
+            memset(data+value_size+2, '-', room-3);
+            data[value_size+room-1] = '\0';
+            self->dead += room;
+        }
+        // Drop other headers with the same name.
+        while (http_cursor_find(&cursor, field, size)) {
+            _kill(self, &cursor);
+        }
+        _cache_clear(self);
+        _trim(self);
+        return 1;
+    }
+    // Measure the first match now: a failed push may still move the buffer,
+    // which leaves the cursor's pointers dangling (its offsets survive).
+    room = self->dead + (size_t)(cursor.value - self->data) +
+        cursor.value_size + 1 - cursor.last;
+    // Append the new header before dropping the old ones, so nothing is lost
+    // on failure.
+    if (!_push_header(self, field, size, value, value_size))
+    {
+        // Else, drop them first if that, with compaction, makes enough room.
+        while (http_cursor_find(&cursor, field, size)) {
+            room += (size_t)(cursor.value - self->data) +
+                cursor.value_size + 1 - cursor.last;
+        }
+        if ((self->used - room + size + value_size + 3) > self->limit) {
+            return 0;
+        }
+        http_head_remove(self, field, size);
+        http_head_compact(self);
+        return (_push_header(self, field, size, value, value_size));
+    }
+    http_cursor_init(&cursor, self);
+    while (http_cursor_find(&cursor, field, size) && (cursor.last < base)) {
+        _kill(self, &cursor);
+    }
+    _trim(self);
+    return 1;
 }
 
-static int _push_value (http_head * self, const char * value, size_t size)
+void http_head_compact (http_head * self)
 {
+    size_t base = 0;
     size_t used = 0;
-    // Check that enough space is remaining.
-    if ((self->size-self->used-2) < size) {
+    size_t span = 0;
+    if (self->dead == 0) {
+        return;
+    }
+    // Slide live headers over dead ones, in a single pass.
+    while (base < self->used)
+    {
+        span = next_segment(self->data+base, self->used-base) + 1;
+        span += next_segment(self->data+base+span, self->used-base-span) + 1;
+        if (self->data[base] != CHTTP_DEAD) {
+            memmove(self->data+used, self->data+base, span), used += span;
+        }
+        base += span;
+    }
+    self->data[self->used=used] = '\0';
+    self->dead = 0;
+    if (self->index != 0) {
+        _index_build(self, 16);
+    }
+}
+
+int http_head_clone (http_head * self, const http_head * other,
+                     const http_allocator * allocator)
+{
+    const size_t size = (other->size > other->used)? other->size : 1;
+    struct http_index * index = 0;
+    if (!http_head_init_ex(self, size, other->limit, allocator)) {
         return 0;
     }
-    // Copy data.
-    while ((used < size) && (value[used] != '\0')) {
-        self->data[self->used++] = value[used++];
+    if (other->used > 0) {
+        memcpy(self->data, other->data, other->used+1);
+    }
+    self->used = other->used;
+    self->dead = other->dead;
+    self->options = other->options;
+    // The index only holds offsets, so it can be copied as is.
+    if (other->index != 0) {
+        index = self->allocator->acquire(self->allocator->context,
+                                         _index_size(other->index->size));
+        if ((self->index=index) != 0) {
+            memcpy(index, other->index, _index_size(other->index->size));
+        }
     }
-    // Add null terminator.
-    self->data[self->used] = '\0';
     return 1;
 }
 
-int http_head_push_value (http_mark * self, const char * field, size_t size)
+// Copy @a size bytes of headers to the end of the buffer.
+static int _splice (http_head * self, const char * data, size_t size)
 {
-    // Swich to value if necessary.
-    if (self->mode == 0)
+    if (!_reserve(self, 1, size)) {
+        return 0;
+    }
+    memcpy(self->data+self->used, data, size);
+    self->data[self->used+=size] = '\0';
+    return 1;
+}
+
+// Finish appending the headers found from offset @a base on.
+static void _spliced (http_head * self, const http_head * other, size_t base)
+{
+    struct http_index * index = self->index;
+    const size_t used = base;
+    size_t span = 0;
+    size_t size = 0;
+    int build = 0;
+    const int fold = ((self->options & HTTP_HEAD_LOWERCASE) != 0) &&
+        ((other->options & HTTP_HEAD_LOWERCASE) == 0);
+    for (; base < self->used; base += span)
     {
-        // Disallow empty names.
-        if (self->head->used == self->base) {
-            return 0;
+        span = next_segment(self->data+base, self->used-base);
+        if (fold && (self->data[base] != CHTTP_TOKEN)) {
+            _lower(self->data+base, span);
+        }
+        // Grow (or drop) the index when it gets too crowded.
+        if ((index != 0) && !build && (2*(index->used+1) > index->size)) {
+            build = 1;
         }
-        ++(self->head->used), self->mode = 1;
+        if ((index != 0) && !build) {
+            _index_put(index, _hash(_field(self, self->data+base), &size),
+                       base);
+        }
+        span += next_segment(self->data+base+span+1,
+                             self->used-base-span-1) + 2;
     }
-    // Make sure we're still inserting header data.
-    if (self->mode != 1) {
-        return 0;
+    if (build) {
+        _index_build(self, 16);
     }
-    return (_push_value(self->head, field, size));
+    else if (index != 0) {
+        index->edge = self->used;
+    }
+    _cache_clear(self);
+    CHTTP_COUNT(bytes, self->used-used);
+    CHTTP_PEAK(peak_used, self->used);
+    CHTTP_PEAK(peak_fill, (unsigned long long)self->used*1000 / self->size);
 }
 
-static int _commit (http_head * self, size_t mark)
+int http_head_append_if (http_head * self, const http_head * other,
+                         http_head_filter filter, void * context)
 {
-    size_t nulls = 0;
-    // Validate the mark.
-    if (mark >= (self->size-3)) {
+    http_cursor cursor;
+    const size_t base = self->used;
+    size_t start = 0;
+    size_t stop = 0;
+    int keep = 1;
+    // Copy runs of consecutive headers that are kept.
+    http_cursor_init(&cursor, other);
+    while (http_cursor_next(&cursor))
+    {
+        if (filter != 0) {
+            keep = filter(context, cursor.field, cursor.field_size,
+                          cursor.value, cursor.value_size);
+        }
+        if (keep < 0) {
+            break;
+        }
+        if ((keep == 0) || (cursor.last != stop)) {
+            if (!_splice(self, other->data+start, stop-start)) {
+                self->data[self->used=base] = '\0';
+                return 0;
+            }
+            start = stop = cursor.last;
+        }
+        if (keep > 0) {
+            stop = cursor.base;
+        }
+    }
+    if (!_splice(self, other->data+start, stop-start)) {
+        self->data[self->used=base] = '\0';
         return 0;
     }
-    // Verify that the partial operations put valid null terminators.
-    while (mark <= self->used) {
-        nulls += (self->data[mark++] == '\0');
+    _spliced(self, other, base);
+    return 1;
+}
+
+int http_head_append_all (http_head * self, const http_head * other)
+{
+    const size_t base = self->used;
+    if (other->dead != 0) {
+        return (http_head_append_if(self, other, 0, 0));
     }
-    if ((nulls != 2) || (self->data[self->used] != '\0')) {
+    if (!_splice(self, other->data, other->used)) {
         return 0;
     }
-    // Restore buffer invariant.
-    self->data[self->used++] = '\0';
+    _spliced(self, other, base);
     return 1;
 }
 
-int http_head_commit (http_mark * self)
+// Names left out by @c http_head_append_except.
+typedef struct http_deny
 {
-    // Allow empty values.
-    if (self->mode == 0)
+    const char * const * fields;
+    size_t count;
+} http_deny;
+
+static int _deny (void * context, const char * field, size_t size,
+                  const char * value, size_t value_size)
+{
+    const http_deny * deny = context;
+    size_t i = 0;
+    for (i = 0; i < deny->count; ++i)
     {
-        // Disallow empty names.
-        if (self->head->used == self->base) {
+        if (_strnieq(field, deny->fields[i], size) &&
+            (deny->fields[i][size] == '\0')) {
             return 0;
         }
-        // Switch to writing header data.
-        ++(self->head->used), self->mode = 1;
     }
-    // Make sure we're still inserting header data.
-    if (self->mode != 1) {
-        return 0;
+    return 1;
+}
+
+int http_head_append_except (http_head * self, const http_head * other,
+                             const char * const * fields, size_t count)
+{
+    http_deny deny;
+    deny.fields = fields;
+    deny.count = count;
+    return (http_head_append_if(self, other, _deny, &deny));
+}
+
+#if defined(_MSC_VER)
+#   define CHTTP_RETAIN(count) _InterlockedIncrement(count)
+#   define CHTTP_RELEASE(count) _InterlockedDecrement(count)
+#else
+#   define CHTTP_RETAIN(count) __atomic_add_fetch(count, 1, __ATOMIC_RELAXED)
+#   define CHTTP_RELEASE(count) __atomic_sub_fetch(count, 1, __ATOMIC_ACQ_REL)
+#endif
+
+struct http_snapshot
+{
+    // Number of references, only updated atomically.
+    long references;
+    // Read-only view of the index and data that follow.
+    http_head head;
+};
+
+// Frozen heads never (re)allocate.
+static void * _frozen_acquire (void * context, size_t size)
+{
+    return (0);
+}
+
+static void * _frozen_resize (void * context, void * data,
+                              size_t used, size_t size)
+{
+    return (0);
+}
+
+static void _frozen_release (void * context, void * data, size_t size)
+{
+}
+
+static const http_allocator _frozen_allocator = {
+    _frozen_acquire, _frozen_resize, _frozen_release, 0,
+};
+
+http_snapshot * http_head_freeze (const http_head * self)
+{
+    http_snapshot * snapshot = 0;
+    struct http_index * index = 0;
+    http_cursor cursor;
+    char * data = 0;
+    size_t count = 0;
+    size_t used = 0;
+    size_t size = 16;
+    size_t span = 0;
+    // Measure live headers.
+    http_cursor_init(&cursor, self);
+    while (http_cursor_next(&cursor)) {
+        ++count, used += cursor.base - cursor.last;
+    }
+    while (size < 2*(count+1)) {
+        size *= 2;
+    }
+    // Put everything in one block: header, index, then data.
+    snapshot = malloc(sizeof(http_snapshot) + _index_size(size) + used + 1);
+    if (snapshot == 0) {
+        return (0);
+    }
+    index = (struct http_index*)(snapshot + 1);
+    memset(index, 0, _index_size(size));
+    index->size = size;
+    data = (char*)index + _index_size(size);
+    // Copy live headers back to back, indexing them along the way.
+    http_cursor_init(&cursor, self);
+    for (used = 0; http_cursor_next(&cursor); used += span)
+    {
+        span = cursor.base - cursor.last;
+        memcpy(data+used, self->data+cursor.last, span);
+        _index_put(index, _hash(cursor.field, &count), used);
     }
-    return (_commit(self->head, self->base));
+    data[used] = '\0';
+    index->edge = used;
+    snapshot->references = 1;
+    snapshot->head.data = data;
+    snapshot->head.size = snapshot->head.limit = used + 1;
+    snapshot->head.used = used;
+    snapshot->head.dead = 0;
+    snapshot->head.index = index;
+    snapshot->head.cache = 0;
+    snapshot->head.storage = 0;
+    snapshot->head.allocator = &_frozen_allocator;
+    snapshot->head.options = self->options;
+    return (snapshot);
 }
 
-static int _cancel (http_head * self, size_t mark)
+http_snapshot * http_snapshot_retain (http_snapshot * self)
 {
-    // Validate the mark.
-    if ((mark >= (self->size-3))) {
+    CHTTP_RETAIN(&self->references);
+    return (self);
+}
+
+void http_snapshot_release (http_snapshot * self)
+{
+    if ((self != 0) && (CHTTP_RELEASE(&self->references) == 0)) {
+        free(self);
+    }
+}
+
+const http_head * http_snapshot_head (const http_snapshot * self)
+{
+    return (&self->head);
+}
+
+// Parser states.
+enum
+{
+    state_line,
+    state_field,
+    state_space,
+    state_value,
+    state_newline,
+    state_end,
+    state_done,
+    state_fail,
+};
+
+static int _is_space (char c)
+{
+    return ((c == ' ') || (c == '\t'));
+}
+
+void http_parser_init (http_parser * self, http_head * head)
+{
+    self->head = head;
+    self->state = state_line;
+    self->space = 0;
+}
+
+static size_t _parser_abort (http_parser * self, size_t used)
+{
+    // Roll back the header we were parsing, if any.
+    if ((self->state > state_line) && (self->state < state_end)) {
+        http_head_cancel(&self->mark);
+    }
+    self->state = state_fail;
+    return (used);
+}
+
+static int _parser_commit (http_parser * self)
+{
+    http_head * head = self->head;
+    // Strip trailing whitespace from the header data.
+    head->data[head->used-=self->space] = '\0', self->space = 0;
+    if (!http_head_commit(&self->mark)) {
         return 0;
     }
-    // Restore buffer invariants.
-    self->data[self->used=mark] = '\0';
+    self->state = state_line;
     return 1;
 }
 
-int http_head_cancel (http_mark * self)
+size_t http_parser_feed (http_parser * self, const char * data, size_t size)
 {
-    return (_cancel(self->head, self->base));
+    static const char field[4] = { ':', '\r', '\n', '\0' };
+    static const char value[4] = { '\r', '\n', '\0', '\0' };
+    size_t used = 0;
+    size_t span = 0;
+    size_t text = 0;
+    for (; (used < size) && (self->state < state_done); ++used)
+    {
+        switch (self->state)
+        {
+        case state_line:
+            // Blank line ends the headers.
+            if (data[used] == '\r') {
+                self->state = state_end;
+                break;
+            }
+            if (data[used] == '\n') {
+                self->state = state_done;
+                break;
+            }
+            // Obsolete line folding is not supported.
+            if (_is_space(data[used]) ||
+                !http_head_mark(self->head, &self->mark)) {
+                return (_parser_abort(self, used));
+            }
+            self->state = state_field;
+            // Fall through.
+        case state_field:
+            span = CHTTP_KERNEL(_find)(data+used, size-used, field);
+            if (!http_head_push_field(&self->mark, data+used, span)) {
+                return (_parser_abort(self, used));
+            }
+            if ((used += span) == size) {
+                return (used);
+            }
+            // Reject empty names and whitespace before the colon.
+            if ((data[used] != ':') ||
+                (self->head->used == self->mark.base) ||
+                _is_space(self->head->data[self->head->used-1])) {
+                return (_parser_abort(self, used));
+            }
+            self->state = state_space;
+            break;
+        case state_space:
+            // Skip leading whitespace.
+            if (_is_space(data[used])) {
+                break;
+            }
+            if (!http_head_push_value(&self->mark, "", 0)) {
+                return (_parser_abort(self, used));
+            }
+            self->state = state_value;
+            // Fall through.
+        case state_value:
+            span = CHTTP_KERNEL(_find)(data+used, size-used, value);
+            if (!http_head_push_value(&self->mark, data+used, span)) {
+                return (_parser_abort(self, used));
+            }
+            // Track trailing whitespace, which may span several reads.
+            for (text = span; (text > 0) && _is_space(data[used+text-1]);) {
+                --text;
+            }
+            self->space = (text == 0)? self->space+span : span-text;
+            if ((used += span) == size) {
+                return (used);
+            }
+            if (data[used] == '\n') {
+                if (!_parser_commit(self)) {
+                    return (_parser_abort(self, used));
+                }
+                break;
+            }
+            if (data[used] != '\r') {
+                return (_parser_abort(self, used));
+            }
+            self->state = state_newline;
+            break;
+        case state_newline:
+            if ((data[used] != '\n') || !_parser_commit(self)) {
+                return (_parser_abort(self, used));
+            }
+            break;
+        case state_end:
+            if (data[used] != '\n') {
+                return (_parser_abort(self, used));
+            }
+            self->state = state_done;
+            break;
+        }
+    }
+    return (used);
 }
 
-void http_cursor_init (http_cursor * self, const http_head * head)
+int http_parser_done (const http_parser * self)
 {
-    self->head = head;
-    self->base = 0;
-    self->field = self->value = 0;
+    return (self->state == state_done);
 }
 
-int http_cursor_next (http_cursor * self)
+int http_parser_fail (const http_parser * self)
 {
-    char * text = self->head->data + self->base;
-    // Guard against empty head & extra iterations.
-    if (*text == '\0') {
-        self->field = self->value = "";
-        return (0);
+    return (self->state == state_fail);
+}
+
+int http_stats_read (http_stats * stats)
+{
+#if defined(CHTTP_STATS)
+    const unsigned long long * counter = (const unsigned long long*)&_stats;
+    unsigned long long * copy = (unsigned long long*)stats;
+    size_t i = 0;
+    for (i = 0; i < sizeof(http_stats)/sizeof(*counter); ++i) {
+#if defined(_MSC_VER)
+        copy[i] = (unsigned long long)_InterlockedCompareExchange64(
+            (volatile __int64*)&counter[i], 0, 0);
+#else
+        copy[i] = __atomic_load_n(&counter[i], __ATOMIC_RELAXED);
+#endif
     }
-    self->field = text, self->base += next_segment(&text);
-    self->value = text, self->base += next_segment(&text);
-    return (1);
+    return 1;
+#else
+    memset(stats, 0, sizeof(http_stats));
+    return 0;
+#endif
+}
+
+void http_stats_reset (void)
+{
+#if defined(CHTTP_STATS)
+    unsigned long long * counter = (unsigned long long*)&_stats;
+    size_t i = 0;
+    for (i = 0; i < sizeof(http_stats)/sizeof(*counter); ++i) {
+#if defined(_MSC_VER)
+        _InterlockedExchange64((volatile __int64*)&counter[i], 0);
+#else
+        __atomic_store_n(&counter[i], 0, __ATOMIC_RELAXED);
+#endif
+    }
+#endif
+}
+
+void http_stats_observe (http_stats_hook hook, void * context)
+{
+#if defined(CHTTP_STATS)
+    _hook = hook, _hook_context = context;
+#endif
 }
@@ -29,9 +29,111 @@
  */
 
 #include "chttp.hpp"
+#include <cstring>
+#include <ostream>
 
 namespace http {
 
+    View::View ()
+        : myData(""), mySize(0)
+    {
+    }
+
+    View::View (const char * data)
+        : myData(data), mySize(std::strlen(data))
+    {
+    }
+
+    View::View (const char * data, std::size_t size)
+        : myData(data), mySize(size)
+    {
+    }
+
+    View::View (const std::string& data)
+        : myData(data.data()), mySize(data.size())
+    {
+    }
+
+#if defined(CHTTP_STRING_VIEW)
+    View::View (std::string_view data)
+        : myData(data.data()), mySize(data.size())
+    {
+    }
+#endif
+
+    const char * View::data () const
+    {
+        return (myData);
+    }
+
+    std::size_t View::size () const
+    {
+        return (mySize);
+    }
+
+    bool View::empty () const
+    {
+        return (mySize == 0);
+    }
+
+    const char * View::begin () const
+    {
+        return (myData);
+    }
+
+    const char * View::end () const
+    {
+        return (myData + mySize);
+    }
+
+    char View::operator[] (std::size_t i) const
+    {
+        return (myData[i]);
+    }
+
+    View::operator std::string () const
+    {
+        return (std::string(myData, mySize));
+    }
+
+#if defined(CHTTP_STRING_VIEW)
+    View::operator std::string_view () const
+    {
+        return (std::string_view(myData, mySize));
+    }
+#endif
+
+    bool operator== (const View& lhs, const View& rhs)
+    {
+        return ((lhs.size() == rhs.size()) &&
+                (std::memcmp(lhs.data(), rhs.data(), lhs.size()) == 0));
+    }
+
+    bool operator!= (const View& lhs, const View& rhs)
+    {
+        return (!(lhs == rhs));
+    }
+
+    std::ostream& operator<< (std::ostream& stream, const View& view)
+    {
+        return (stream.write(view.data(), view.size()));
+    }
+
+    Pool::Pool (std::size_t size, std::size_t count)
+    {
+        ::http_pool_init(&myBackend, size, count);
+    }
+
+    Pool::~Pool ()
+    {
+        ::http_pool_kill(&myBackend);
+    }
+
+    ::http_pool& Pool::backend ()
+    {
+        return (myBackend);
+    }
+
     Head::Head (std::size_t size)
     {
         if (::http_head_init(&myBackend, size) == 0) {
@@ -39,6 +141,37 @@ namespace http {
         }
     }
 
+    Head::Head (std::size_t size, std::size_t limit,
+                const ::http_allocator * allocator)
+    {
+        if (::http_head_init_ex(&myBackend, size, limit, allocator) == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
+    Head::Head (Pool& pool)
+    {
+        if (::http_head_pool_acquire(&myBackend, &pool.backend()) == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
+    Head::Head (const ::http_head& other)
+    {
+        if (::http_head_clone(&myBackend, &other, other.allocator) == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
+    Head::Head (char * data, std::size_t size, std::size_t limit,
+                const ::http_allocator * allocator)
+    {
+        if (::http_head_init_storage(&myBackend,
+                                     data, size, limit, allocator) == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
     Head::~Head ()
     {
         ::http_head_kill(&myBackend);
@@ -54,10 +187,82 @@ namespace http {
         return (myBackend);
     }
 
+    bool Head::append (const Head& other)
+    {
+        return (::http_head_append_all(&myBackend, &other.myBackend) != 0);
+    }
+
+    void Head::swap (Head& other)
+    {
+        ::http_head lhs;
+        ::http_head rhs;
+        if (::http_head_move(&lhs, &myBackend) == 0) {
+            throw (std::bad_alloc());
+        }
+        if (::http_head_move(&rhs, &other.myBackend) == 0) {
+            myBackend = lhs;
+            throw (std::bad_alloc());
+        }
+        myBackend = rhs, other.myBackend = lhs;
+    }
+
+    bool Head::adopt (char * data, std::size_t size, std::size_t used)
+    {
+        ::http_head head;
+        if (::http_head_adopt(&head, data, size, used,
+                              myBackend.limit, myBackend.allocator) == 0) {
+            return (false);
+        }
+        ::http_head_configure(&head, myBackend.options);
+        ::http_head_kill(&myBackend);
+        myBackend = head;
+        return (true);
+    }
+
+    char * Head::release (std::size_t& size, std::size_t& used)
+    {
+        char * data = 0;
+        size = used = 0;
+        if (myBackend.data == 0) {
+            return (0);
+        }
+        data = ::http_head_release(&myBackend, &size, &used);
+        if (data == 0) {
+            throw (std::bad_alloc());
+        }
+        return (data);
+    }
+
+    void Head::reset ()
+    {
+        ::http_head_reset(&myBackend);
+    }
+
     bool Head::push (const std::string& field, const std::string& value)
     {
         return (::http_head_push(&myBackend, field.c_str(),
-                                             value.c_str()) == 0);
+                                             value.c_str()) != 0);
+    }
+
+    bool Head::push (const char * field, const char * value)
+    {
+        return (::http_head_push(&myBackend, field, value) != 0);
+    }
+
+    bool Head::push (View field, View value)
+    {
+        ::http_mark mark;
+        if (::http_head_mark(&myBackend, &mark) == 0) {
+            return (false);
+        }
+        if ((::http_head_push_field(&mark, field.data(), field.size()) == 0)
+          ||(::http_head_push_value(&mark, value.data(), value.size()) == 0)
+          ||(::http_head_commit(&mark) == 0))
+        {
+            ::http_head_cancel(&mark);
+            return (false);
+        }
+        return (true);
     }
 
     std::string Head::find (const std::string& field) const
@@ -65,11 +270,86 @@ namespace http {
         return (::http_head_find(&myBackend, field.c_str()));
     }
 
+    View Head::find (View field) const
+    {
+        return (::http_head_findn(&myBackend, field.data(), field.size()));
+    }
+
+    View Head::find (const char * field) const
+    {
+        return (::http_head_find(&myBackend, field));
+    }
+
+    View Head::find (::http_header id) const
+    {
+        return (::http_head_find_id(&myBackend, id));
+    }
+
+    Values Head::find_all (View field) const
+    {
+        return (Values(*this, field));
+    }
+
+    int Head::get_u64 (View field, unsigned long long& value)
+    {
+        return (::http_head_get_u64(&myBackend,
+                                    field.data(), field.size(), &value));
+    }
+
+    int Head::get_date (View field, std::time_t& value)
+    {
+        return (::http_head_get_date(&myBackend,
+                                     field.data(), field.size(), &value));
+    }
+
+    std::size_t Head::remove (View field)
+    {
+        return (::http_head_remove(&myBackend, field.data(), field.size()));
+    }
+
+    bool Head::replace (View field, View value)
+    {
+        return (::http_head_replace(&myBackend, field.data(), field.size(),
+                                    value.data(), value.size()) != 0);
+    }
+
+    void Head::compact ()
+    {
+        ::http_head_compact(&myBackend);
+    }
+
+    void Head::configure (unsigned int options)
+    {
+        ::http_head_configure(&myBackend, options);
+    }
+
+    Snapshot Head::freeze () const
+    {
+        return (Snapshot(*this));
+    }
+
+    void Head::index ()
+    {
+        if (::http_head_index(&myBackend) == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
+    void swap (Head& lhs, Head& rhs)
+    {
+        lhs.swap(rhs);
+    }
+
     Cursor::Cursor (const Head& head)
     {
         ::http_cursor_init(&myBackend, &head.backend());
     }
 
+    Cursor::Cursor (const Snapshot& snapshot)
+    {
+        ::http_cursor_init(&myBackend, &snapshot.backend());
+    }
+
     bool Cursor::next ()
     {
         return (::http_cursor_next(&myBackend) != 0);
@@ -77,12 +357,182 @@ namespace http {
 
     std::string Cursor::field () const
     {
-        return (myBackend.field);
+        return (std::string(myBackend.field, myBackend.field_size));
     }
 
     std::string Cursor::value () const
     {
-        return (myBackend.value);
+        return (std::string(myBackend.value, myBackend.value_size));
+    }
+
+    View Cursor::field_view () const
+    {
+        return (View(myBackend.field, myBackend.field_size));
+    }
+
+    View Cursor::value_view () const
+    {
+        return (View(myBackend.value, myBackend.value_size));
+    }
+
+    bool Cursor::find (View field)
+    {
+        return (::http_cursor_find(&myBackend,
+                                   field.data(), field.size()) != 0);
+    }
+
+    Values::iterator::iterator ()
+        : myField(), myEnd(true)
+    {
+        std::memset(&myCursor, 0, sizeof(myCursor));
+    }
+
+    Values::iterator::iterator (const ::http_head& head, View field)
+        : myField(field), myEnd(false)
+    {
+        ::http_cursor_init(&myCursor, &head);
+        ++*this;
+    }
+
+    View Values::iterator::operator* () const
+    {
+        return (View(myCursor.value, myCursor.value_size));
+    }
+
+    Values::iterator& Values::iterator::operator++ ()
+    {
+        myEnd = (::http_cursor_find(&myCursor,
+                                    myField.data(), myField.size()) == 0);
+        return (*this);
+    }
+
+    Values::iterator Values::iterator::operator++ (int)
+    {
+        iterator previous(*this);
+        ++*this;
+        return (previous);
+    }
+
+    bool Values::iterator::operator== (const iterator& rhs) const
+    {
+        if (myEnd || rhs.myEnd) {
+            return (myEnd == rhs.myEnd);
+        }
+        return (myCursor.value == rhs.myCursor.value);
+    }
+
+    bool Values::iterator::operator!= (const iterator& rhs) const
+    {
+        return (!(*this == rhs));
+    }
+
+    Values::Values (const Head& head, View field)
+        : myHead(&head.backend()), myField(field)
+    {
+    }
+
+    Values::Values (const Snapshot& snapshot, View field)
+        : myHead(&snapshot.backend()), myField(field)
+    {
+    }
+
+    Values::iterator Values::begin () const
+    {
+        return (iterator(*myHead, myField));
+    }
+
+    Values::iterator Values::end () const
+    {
+        return (iterator());
+    }
+
+    bool Values::empty () const
+    {
+        return (begin() == end());
+    }
+
+    std::string Values::join () const
+    {
+        const std::size_t size = ::http_head_coalesce(
+            myHead, myField.data(), myField.size(), 0, 0);
+        std::string values(size, '\0');
+        if (size > 0) {
+            ::http_head_coalesce(myHead, myField.data(), myField.size(),
+                                 &values[0], size+1);
+        }
+        return (values);
+    }
+
+    Snapshot::Snapshot (const Head& head)
+        : myBackend(::http_head_freeze(&head.backend()))
+    {
+        if (myBackend == 0) {
+            throw (std::bad_alloc());
+        }
+    }
+
+    Snapshot::Snapshot (const Snapshot& other)
+        : myBackend(::http_snapshot_retain(other.myBackend))
+    {
+    }
+
+    Snapshot::~Snapshot ()
+    {
+        ::http_snapshot_release(myBackend);
+    }
+
+    Snapshot& Snapshot::operator= (const Snapshot& other)
+    {
+        // Retain first, in case both share the same headers.
+        ::http_snapshot * backend = ::http_snapshot_retain(other.myBackend);
+        ::http_snapshot_release(myBackend);
+        myBackend = backend;
+        return (*this);
+    }
+
+    const ::http_head& Snapshot::backend () const
+    {
+        return (*::http_snapshot_head(myBackend));
+    }
+
+    View Snapshot::find (View field) const
+    {
+        return (::http_head_findn(&backend(), field.data(), field.size()));
+    }
+
+    View Snapshot::find (const char * field) const
+    {
+        return (::http_head_find(&backend(), field));
+    }
+
+    View Snapshot::find (::http_header id) const
+    {
+        return (::http_head_find_id(&backend(), id));
+    }
+
+    Values Snapshot::find_all (View field) const
+    {
+        return (Values(*this, field));
+    }
+
+    Parser::Parser (Head& head)
+    {
+        ::http_parser_init(&myBackend, &head.backend());
+    }
+
+    std::size_t Parser::feed (const char * data, std::size_t size)
+    {
+        return (::http_parser_feed(&myBackend, data, size));
+    }
+
+    bool Parser::done () const
+    {
+        return (::http_parser_done(&myBackend) != 0);
+    }
+
+    bool Parser::fail () const
+    {
+        return (::http_parser_fail(&myBackend) != 0);
     }
 
 }
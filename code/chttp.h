@@ -32,103 +32,955 @@
  */
 
 #include <stddef.h>
+#include <time.h>
 
 #ifdef __cplusplus
 extern "C" {
 #endif
 
+// Defined in <sys/uio.h>.
+struct iovec;
+
+/*!
+ * @brief Identifiers for well-known HTTP header names.
+ *
+ * @see http_head_find_id
+ * @see http_header_id
+ * @see http_header_name
+ */
+typedef enum http_header
+{
+    HTTP_HEADER_UNKNOWN = 0,
+    HTTP_HEADER_ACCEPT,
+    HTTP_HEADER_ACCEPT_CHARSET,
+    HTTP_HEADER_ACCEPT_ENCODING,
+    HTTP_HEADER_ACCEPT_LANGUAGE,
+    HTTP_HEADER_ACCEPT_RANGES,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_CREDENTIALS,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_HEADERS,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_METHODS,
+    HTTP_HEADER_ACCESS_CONTROL_ALLOW_ORIGIN,
+    HTTP_HEADER_ACCESS_CONTROL_EXPOSE_HEADERS,
+    HTTP_HEADER_ACCESS_CONTROL_MAX_AGE,
+    HTTP_HEADER_ACCESS_CONTROL_REQUEST_HEADERS,
+    HTTP_HEADER_ACCESS_CONTROL_REQUEST_METHOD,
+    HTTP_HEADER_AGE,
+    HTTP_HEADER_ALLOW,
+    HTTP_HEADER_ALT_SVC,
+    HTTP_HEADER_AUTHORIZATION,
+    HTTP_HEADER_CACHE_CONTROL,
+    HTTP_HEADER_CONNECTION,
+    HTTP_HEADER_CONTENT_DISPOSITION,
+    HTTP_HEADER_CONTENT_ENCODING,
+    HTTP_HEADER_CONTENT_LANGUAGE,
+    HTTP_HEADER_CONTENT_LENGTH,
+    HTTP_HEADER_CONTENT_LOCATION,
+    HTTP_HEADER_CONTENT_RANGE,
+    HTTP_HEADER_CONTENT_SECURITY_POLICY,
+    HTTP_HEADER_CONTENT_TYPE,
+    HTTP_HEADER_COOKIE,
+    HTTP_HEADER_DATE,
+    HTTP_HEADER_ETAG,
+    HTTP_HEADER_EXPECT,
+    HTTP_HEADER_EXPIRES,
+    HTTP_HEADER_FORWARDED,
+    HTTP_HEADER_FROM,
+    HTTP_HEADER_HOST,
+    HTTP_HEADER_IF_MATCH,
+    HTTP_HEADER_IF_MODIFIED_SINCE,
+    HTTP_HEADER_IF_NONE_MATCH,
+    HTTP_HEADER_IF_RANGE,
+    HTTP_HEADER_IF_UNMODIFIED_SINCE,
+    HTTP_HEADER_KEEP_ALIVE,
+    HTTP_HEADER_LAST_MODIFIED,
+    HTTP_HEADER_LINK,
+    HTTP_HEADER_LOCATION,
+    HTTP_HEADER_MAX_FORWARDS,
+    HTTP_HEADER_ORIGIN,
+    HTTP_HEADER_PRAGMA,
+    HTTP_HEADER_PROXY_AUTHENTICATE,
+    HTTP_HEADER_PROXY_AUTHORIZATION,
+    HTTP_HEADER_PROXY_CONNECTION,
+    HTTP_HEADER_RANGE,
+    HTTP_HEADER_REFERER,
+    HTTP_HEADER_REFRESH,
+    HTTP_HEADER_RETRY_AFTER,
+    HTTP_HEADER_SERVER,
+    HTTP_HEADER_SET_COOKIE,
+    HTTP_HEADER_STRICT_TRANSPORT_SECURITY,
+    HTTP_HEADER_TE,
+    HTTP_HEADER_TRAILER,
+    HTTP_HEADER_TRANSFER_ENCODING,
+    HTTP_HEADER_UPGRADE,
+    HTTP_HEADER_UPGRADE_INSECURE_REQUESTS,
+    HTTP_HEADER_USER_AGENT,
+    HTTP_HEADER_VARY,
+    HTTP_HEADER_VIA,
+    HTTP_HEADER_WWW_AUTHENTICATE,
+    HTTP_HEADER_X_CONTENT_TYPE_OPTIONS,
+    HTTP_HEADER_X_FORWARDED_FOR,
+    HTTP_HEADER_X_FORWARDED_HOST,
+    HTTP_HEADER_X_FORWARDED_PROTO,
+    HTTP_HEADER_X_FRAME_OPTIONS,
+    HTTP_HEADER_X_REAL_IP,
+    HTTP_HEADER_X_REQUEST_ID,
+    HTTP_HEADER_X_REQUESTED_WITH,
+
+    /*!
+     * @private
+     * @brief Number of well-known header names, plus one.
+     */
+    HTTP_HEADER_COUNT
+
+} http_header;
+
+/*!
+ * @brief Option for @c http_head_configure: store well-known header names as
+ *  compact tokens.
+ *
+ * Names listed in @c http_header take 2 bytes in the buffer instead of their
+ * full length, and @c http_head_find_id locates them by integer comparison.
+ * Iteration exposes their canonical spelling (e.g. @c "Content-Length"),
+ * regardless of the case used when they were pushed.
+ */
+#define HTTP_HEAD_TOKENS 0x01u
+
+/*!
+ * @brief Option for @c http_head_configure: store header names in lowercase.
+ *
+ * Names are folded as they are pushed, including the canonical spelling of
+ * tokens (e.g. @c "content-length"), as HTTP/2 requires.  Lookups still
+ * ignore case, but only need to fold the name they look for.
+ */
+#define HTTP_HEAD_LOWERCASE 0x02u
+
+/*!
+ * @brief Memory management callbacks.
+ *
+ * Lets clients place buffers in their own memory (e.g. per-connection
+ * arenas).  Each callback receives @c context as its first argument.
+ *
+ * @see http_head_init_ex
+ */
+typedef struct http_allocator
+{
+    /*!
+     * @brief Allocate @a size bytes, return null on failure.
+     */
+    void * (*acquire) (void * context, size_t size);
+
+    /*!
+     * @brief Move @a data to a block of @a size bytes, return null on failure.
+     *
+     * Only the first @a used bytes need to be preserved.  On failure, @a data
+     * must be left untouched.
+     */
+    void * (*resize) (void * context, void * data, size_t used, size_t size);
+
+    /*!
+     * @brief Release @a data, which was allocated with @a size bytes.
+     */
+    void (*release) (void * context, void * data, size_t size);
+
+    /*!
+     * @brief Client data, passed to all callbacks.
+     */
+    void * context;
+
+} http_allocator;
+
+/*!
+ * @brief Buffer for HTTP headers.
+ *
+ * The buffer uses a flat representation, all values are stored into a single
+ * contiguous chunk of memory.  This representation is convenient for
+ * long-lived processes where memory fragmentation is a problem.
+ *
+ * Headers are edited in place.  Removing a header only marks it as dead, so
+ * cursors and lookups skip it while its bytes stay in the buffer (see @c
+ * dead).  Replacing a header overwrites its data when the new data fits, and
+ * otherwise appends a new header and marks the old one as dead.  Dead bytes
+ * are reclaimed by @c http_head_compact, which slides the live headers down
+ * and runs automatically once half of the buffer is dead.
+ *
+ * @see http_head_init
+ * @see http_head_kill
+ * @see http_head_push
+ * @see http_head_find
+ * @see http_head_remove
+ * @see http_head_replace
+ * @see http_head_compact
+ * @see http_cursor
+ */
+typedef struct http_head
+{
+    /*!
+     * @private
+     * @brief Pointer to the memory chunk containing the headers.
+     * @invariant Points to at least @c size bytes.
+     * @invariant @c data[used] is a null character.
+     */
+    char * data;
+
+    /*!
+     * @private
+     * @brief Buffer capacity.
+     * @brief Size 
+     */
+    size_t size;
+
+    /*!
+     * @private
+     * @brief Current buffer usage.
+     * @invariant Less than or equal to @c size.
+     */
+    size_t used;
+
+    /*!
+     * @private
+     * @brief Number of bytes held by removed headers.
+     *
+     * @see http_head_compact
+     */
+    size_t dead;
+
+    /*!
+     * @private
+     * @brief Optional hash table over header names, null when disabled.
+     *
+     * @see http_head_index
+     */
+    struct http_index * index;
+
+    /*!
+     * @private
+     * @brief Values parsed by typed accessors, null until first needed.
+     *
+     * @see http_head_get_u64
+     */
+    struct http_cache * cache;
+
+    /*!
+     * @private
+     * @brief Memory management callbacks.
+     */
+    const http_allocator * allocator;
+
+    /*!
+     * @private
+     * @brief Caller-provided memory, which is never released, or null.
+     *
+     * @see http_head_init_storage
+     */
+    char * storage;
+
+    /*!
+     * @private
+     * @brief Maximum buffer capacity.
+     * @invariant Greater than or equal to @c size.
+     */
+    size_t limit;
+
+    /*!
+     * @private
+     * @brief Options set using @c http_head_configure.
+     */
+    unsigned int options;
+
+} http_head;
+
+/*!
+ * @brief Create an empty buffer with a capacity of @a size bytes.
+ * @param self
+ * @param size Buffer capacity (fixed).
+ * @return 0 if memory allocation fails, else non-zero.
+ *
+ * @memberof http_head
+ */
+int http_head_init (http_head * self, size_t size);
+
+/*!
+ * @brief Create an empty buffer that grows as needed.
+ * @param self
+ * @param size Initial buffer capacity.
+ * @param limit Maximum buffer capacity.  The buffer has a fixed capacity if
+ *  this is less than or equal to @a size.
+ * @param allocator Memory management callbacks, or null to use @c malloc()
+ *  and friends.  Must outlive the buffer.
+ * @return 0 if memory allocation fails, else non-zero.
+ *
+ * When a push needs more space, the capacity doubles (without exceeding @a
+ * limit).  Growth may move the buffer, invalidating pointers obtained with
+ * @c http_head_find or @c http_cursor_next, but marks held by partial push
+ * operations remain valid.
+ *
+ * @memberof http_head
+ * @see http_head_init
+ */
+int http_head_init_ex (http_head * self, size_t size, size_t limit,
+                       const http_allocator * allocator);
+
+/*!
+ * @brief Create an empty buffer in caller-provided memory.
+ * @param self
+ * @param data Memory in which to store headers, e.g. an array on the stack
+ *  or in a connection object.  Must outlive the buffer.
+ * @param size Size of @a data, in bytes.
+ * @param limit Maximum buffer capacity.  The buffer has a fixed capacity if
+ *  this is less than or equal to @a size.
+ * @param allocator Memory management callbacks used once the headers
+ *  outgrow @a data, or null to use @c malloc() and friends.  Must outlive
+ *  the buffer.
+ * @return 0 if @a size is 0, else non-zero.
+ *
+ * Nothing is allocated until the headers need more than @a size bytes.  They
+ * are then copied to memory from @a allocator and grow as with @c
+ * http_head_init_ex.  The library never releases @a data.
+ *
+ * @memberof http_head
+ * @see http_head_init_ex
+ */
+int http_head_init_storage (http_head * self, char * data, size_t size,
+                            size_t limit, const http_allocator * allocator);
+
+/*!
+ * @brief Release the chunk of memory held by the buffer.
+ * @param self
+ * @pre @c http_head_init has been called.
+ * @post @c http_head_init can be called again to recycle the buffer instance.
+ *
+ * @memberof http_head
+ */
+void http_head_kill (http_head * self);
+
+/*!
+ * @brief Transfer the headers and memory of @a other to @a self.
+ * @param self Buffer that receives the headers.  Must not hold any memory.
+ * @param other Buffer that gives up its headers.
+ * @return 0 if @a other lives in caller-provided memory and the headers
+ *  could not be copied to memory from its allocator, else non-zero.
+ * @post On success, @a other holds no memory, as after @c http_head_kill.
+ *
+ * No headers are copied unless @a other uses caller-provided memory, which
+ * has to stay behind.  The index and parsed values move along.  Moving a
+ * buffer that holds no memory leaves @a self without memory too.
+ *
+ * @memberof http_head
+ */
+int http_head_move (http_head * self, http_head * other);
+
+/*!
+ * @brief Take over a chunk of memory that already holds HTTP headers.
+ * @param self
+ * @param data Memory acquired from @a allocator, in the format left by
+ *  @c http_head_release.
+ * @param size Capacity of @a data, in bytes.
+ * @param used Number of bytes used by the headers, excluding the final null
+ *  character.
+ * @param limit Maximum buffer capacity.
+ * @param allocator Memory management callbacks that release @a data, or
+ *  null to use the default allocator.
+ * @return 0 if the headers are malformed, in which case @a data still
+ *  belongs to the caller, else non-zero.
+ *
+ * The headers are checked in a single pass, but not copied.
+ *
+ * @memberof http_head
+ * @see http_head_release
+ */
+int http_head_adopt (http_head * self, char * data, size_t size, size_t used,
+                     size_t limit, const http_allocator * allocator);
+
+/*!
+ * @brief Give up the chunk of memory that holds the HTTP headers.
+ * @param self
+ * @param[out] size Receives the capacity of the memory, in bytes.
+ * @param[out] used Receives the number of bytes used by the headers,
+ *  excluding the final null character.
+ * @return The memory, which the caller must return to the allocator (or
+ *  pass to @c http_head_adopt), or null if the headers live in
+ *  caller-provided memory and could not be copied.
+ * @post On success, @a self holds no memory, as after @c http_head_kill.
+ *
+ * @memberof http_head
+ * @see http_head_adopt
+ */
+char * http_head_release (http_head * self, size_t * size, size_t * used);
+
+/*!
+ * @brief Remove all HTTP headers, keeping the memory for reuse.
+ * @param self
+ *
+ * Use this to recycle the buffer for the next request on a persistent
+ * connection.
+ *
+ * @memberof http_head
+ */
+void http_head_reset (http_head * self);
+
+/*!
+ * @brief Append an HTTP header to the buffer.
+ * @param self
+ * @param field HTTP header name.
+ * @param value HTTP header data.
+ * @return 0 on failure (e.g. attempted to exceed the buffer capacity), else
+ *  non-zero.
+ *
+ * @memberof http_head
+ */
+int http_head_push (http_head * self, const char * field, const char * value);
+
+/*!
+ * @brief Search for an HTTP header by name.
+ * @param self
+ * @param field The name of the HTTP header to look for.
+ * @return @c An empty (zero-length) string if the header was not found, else a
+ *  null-terminated string containing the HTTP header data.
+ *
+ * This method is meant for localized processing of specific HTTP headers (e.g.
+ * the content length).  Unless @c http_head_index has been called, it
+ * performs a linear search from the start of the buffer, so it is usually
+ * more efficient to use an @c http_cursor to iterate over all headers.
+ *
+ * @memberof http_head
+ * @see http_cursor
+ * @see http_head_index
+ */
+const char * http_head_find (const http_head * self, const char * field);
+
+/*!
+ * @brief Search for an HTTP header by name, given as a sized string.
+ * @param self
+ * @param field The name of the HTTP header to look for, which need not be
+ *  null-terminated (e.g. a substring of a receive buffer).
+ * @param size Length of @a field, in bytes.
+ * @return @c An empty (zero-length) string if the header was not found, else a
+ *  null-terminated string containing the HTTP header data.
+ *
+ * @memberof http_head
+ * @see http_head_find
+ */
+const char * http_head_findn (const http_head * self,
+                              const char * field, size_t size);
+
+/*!
+ * @brief Search for an HTTP header by name, with a precomputed hash.
+ * @param self
+ * @param field The name of the HTTP header to look for, which need not be
+ *  null-terminated.
+ * @param size Length of @a field, in bytes.
+ * @param hash Value of @c http_header_hash for @a field.
+ * @return @c An empty (zero-length) string if the header was not found, else a
+ *  null-terminated string containing the HTTP header data.
+ *
+ * When the buffer has an index, @a hash selects the slot without reading
+ * @a field again.  Otherwise, this is the same as @c http_head_findn, which
+ * only compares names of the right length.
+ *
+ * @memberof http_head
+ * @see http_header_hash
+ * @see http_head_index
+ */
+const char * http_head_find_hashed (const http_head * self,
+                                    const char * field, size_t size,
+                                    unsigned int hash);
+
+/*!
+ * @brief Search for a well-known HTTP header.
+ * @param self
+ * @param id Identifier of the HTTP header to look for.
+ * @return An empty (zero-length) string if the header was not found, else a
+ *  null-terminated string containing the HTTP header data.
+ *
+ * Headers stored as tokens are matched by comparing integers.  Others are
+ * compared to the canonical name, ignoring case.
+ *
+ * @memberof http_head
+ * @see HTTP_HEAD_TOKENS
+ */
+const char * http_head_find_id (const http_head * self, http_header id);
+
+/*!
+ * @brief Search for several HTTP headers at once.
+ * @param self
+ * @param fields Names of the HTTP headers to look for.
+ * @param count Number of names in @a fields.
+ * @param[out] values Array of @a count pointers that receives, for each
+ *  name, the data of the first header with that name, or an empty string.
+ * @return The number of names that were found.
+ *
+ * The buffer is scanned once, stopping as soon as all names are found.  When
+ * the same names are looked up in every request, a @c http_lookup avoids
+ * comparing each header with each name.
+ *
+ * @memberof http_head
+ * @see http_head_lookup
+ */
+size_t http_head_find_many (const http_head * self,
+                            const char * const * fields, size_t count,
+                            const char ** values);
+
+/*!
+ * @brief Look up the identifier of a well-known HTTP header.
+ * @param field HTTP header name (case insensitive).
+ * @param size Length of @a field, in bytes.
+ * @return @c HTTP_HEADER_UNKNOWN if @a field is not a well-known name.
+ *
+ * Runs in time proportional to @a size, using a perfect hash.
+ */
+http_header http_header_id (const char * field, size_t size);
+
+/*!
+ * @brief Hash an HTTP header name for @c http_head_find_hashed.
+ * @param field HTTP header name (case insensitive).
+ * @param size Length of @a field, in bytes.
+ * @return The 32-bit FNV-1a hash of @a field, with ASCII letters folded to
+ *  lowercase.
+ *
+ * The function is stable across versions, so the hash of names known in
+ * advance can be computed once (e.g. at compile time, see @c http::Key).
+ */
+unsigned int http_header_hash (const char * field, size_t size);
+
+/*!
+ * @brief Get the canonical name of a well-known HTTP header.
+ * @param id Identifier of the HTTP header.
+ * @return An empty (zero-length) string if @a id is invalid.
+ */
+const char * http_header_name (http_header id);
+
+/*!
+ * @brief Change options for subsequent pushes.
+ * @param self
+ * @param options Combination of @c HTTP_HEAD_TOKENS and
+ *  @c HTTP_HEAD_LOWERCASE, or 0.
+ *
+ * Headers already in the buffer are left as-is, except that enabling
+ * @c HTTP_HEAD_LOWERCASE folds their names.  Don't change options while a
+ * header is being pushed.
+ *
+ * @memberof http_head
+ */
+void http_head_configure (http_head * self, unsigned int options);
+
+/*!
+ * @brief Count the I/O vector entries needed to serialize the buffer.
+ * @param self
+ * @return The number of @c iovec structures that @c http_head_to_iovec will
+ *  fill, 4 per header.
+ *
+ * @memberof http_head
+ * @see http_head_to_iovec
+ */
+size_t http_head_iovec_size (const http_head * self);
+
+/*!
+ * @brief Describe the headers in wire format, without copying them.
+ * @param self
+ * @param[out] iov Array that receives the I/O vector.
+ * @param size Number of entries in @a iov.
+ * @return The number of entries filled, or 0 if @a size is too small.
+ *
+ * Each header is described by 4 entries: the name, a static @c ": "
+ * separator, the data and a static @c "\r\n" terminator.  Names and data
+ * point directly into the buffer, so the result is only valid until the
+ * buffer is modified.  The caller is responsible for the start line and the
+ * blank line that ends the headers, which can be sent in the same @c writev()
+ * call.  Note that @c writev() accepts at most @c IOV_MAX entries.
+ *
+ * Not available on Windows.
+ *
+ * @memberof http_head
+ * @see http_head_iovec_size
+ */
+size_t http_head_to_iovec (const http_head * self,
+                           struct iovec * iov, size_t size);
+
+/*!
+ * @brief Attach a hash index over header names to the buffer.
+ * @param self
+ * @return 0 if memory allocation fails, else non-zero.
+ *
+ * The index maps case-insensitive hashes of header names to their offset in
+ * the buffer so that @c http_head_find runs in constant time regardless of
+ * the number of headers.  Headers already in the buffer are indexed right
+ * away and the index is kept up to date by @c http_head_commit and @c
+ * http_head_cancel.  If memory allocation fails while the index grows, the
+ * index is dropped and @c http_head_find reverts to a linear search.
+ *
+ * @memberof http_head
+ * @see http_head_find
+ */
+int http_head_index (http_head * self);
+
+/*!
+ * @brief Remove all HTTP headers named @a field.
+ * @param self
+ * @param field Name of the HTTP headers to remove (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @return The number of headers removed.
+ *
+ * Headers are marked dead in place, which costs a lookup (see @c
+ * http_cursor_find) but doesn't move other headers.  Cursors skip dead
+ * headers.  Once dead headers occupy more than half the buffer, they are
+ * reclaimed by @c http_head_compact, which invalidates pointers and cursors.
+ *
+ * @memberof http_head
+ * @see http_head_compact
+ */
+size_t http_head_remove (http_head * self, const char * field, size_t size);
+
+/*!
+ * @brief Set the data of the HTTP header named @a field.
+ * @param self
+ * @param field Name of the HTTP header to set (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @param value New HTTP header data.
+ * @param value_size Length of @a value, in bytes.
+ * @return 0 on failure (e.g. attempted to exceed the buffer capacity), else
+ *  non-zero.  On failure, the buffer is unchanged (unless memory allocation
+ *  fails while growing the buffer, in which case the header may be lost).
+ *
+ * The first header named @a field is updated and any others are removed.
+ * The header is appended when there is none.  When the new data has the
+ * same length as the old one or is at least 3 bytes shorter, it is written
+ * in place.  Otherwise, the header moves to the end of the buffer.  Like @c
+ * http_head_remove, this may compact the buffer.
+ *
+ * @memberof http_head
+ * @see http_head_remove
+ */
+int http_head_replace (http_head * self, const char * field, size_t size,
+                       const char * value, size_t value_size);
+
+/*!
+ * @brief Reclaim space held by removed HTTP headers.
+ * @param self
+ *
+ * This moves headers and therefore invalidates pointers obtained with @c
+ * http_head_find or @c http_cursor_next, as well as cursors.  @c
+ * http_head_remove and @c http_head_replace call this when at least half the
+ * buffer is dead.
+ *
+ * @memberof http_head
+ */
+void http_head_compact (http_head * self);
+
+/*!
+ * @brief Make a deep copy of HTTP headers.
+ * @param self Buffer that receives the copy.  Must not hold any memory.
+ * @param other HTTP headers to copy.
+ * @param allocator Memory management callbacks for the copy, or null to use
+ *  the default allocator.
+ * @return 0 if memory could not be acquired, else non-zero.
+ *
+ * The copy has the same capacity, limit and options as @a other.  The
+ * headers are copied with a single @c memcpy, removed headers included, and
+ * so is the index if @a other has one.
+ *
+ * @memberof http_head
+ */
+int http_head_clone (http_head * self, const http_head * other,
+                     const http_allocator * allocator);
+
+/*!
+ * @brief Decide whether to copy an HTTP header.
+ * @param context Value passed to @c http_head_append_if.
+ * @param field Name of the HTTP header.
+ * @param size Length of @a field, in bytes.
+ * @param value Data of the HTTP header (null-terminated).
+ * @param value_size Length of @a value, in bytes.
+ * @return A positive value to copy the header, 0 to skip it, or a negative
+ *  value to stop copying.
+ *
+ * @see http_head_append_if
+ */
+typedef int (*http_head_filter)(void * context,
+                                const char * field, size_t size,
+                                const char * value, size_t value_size);
+
+/*!
+ * @brief Append all HTTP headers in @a other.
+ * @param self
+ * @param other HTTP headers to copy.  Must be a different buffer.
+ * @return 0 if the headers do not fit, in which case nothing is appended,
+ *  else non-zero.
+ *
+ * Headers are copied in bulk, with a single @c memcpy unless @a other holds
+ * removed headers.  Tokens are kept as they are.
+ *
+ * @memberof http_head
+ */
+int http_head_append_all (http_head * self, const http_head * other);
+
+/*!
+ * @brief Append the HTTP headers in @a other selected by @a filter.
+ * @param self
+ * @param other HTTP headers to copy.  Must be a different buffer.
+ * @param filter Called once for each header, in order, until it returns a
+ *  negative value.
+ * @param context Passed to @a filter.
+ * @return 0 if the headers do not fit, in which case nothing is appended,
+ *  else non-zero.
+ *
+ * The headers are visited in a single pass, and consecutive headers that are
+ * kept are copied together.
+ *
+ * @memberof http_head
+ * @see http_head_append_except
+ */
+int http_head_append_if (http_head * self, const http_head * other,
+                         http_head_filter filter, void * context);
+
+/*!
+ * @brief Append the HTTP headers in @a other, except those named in @a fields.
+ * @param self
+ * @param other HTTP headers to copy.  Must be a different buffer.
+ * @param fields Names of the HTTP headers to leave out (case insensitive).
+ * @param count Number of names in @a fields.
+ * @return 0 if the headers do not fit, in which case nothing is appended,
+ *  else non-zero.
+ *
+ * This is handy to drop hop-by-hop headers when forwarding a request.
+ *
+ * @memberof http_head
+ * @see http_head_append_if
+ */
+int http_head_append_except (http_head * self, const http_head * other,
+                             const char * const * fields, size_t count);
+
+/*!
+ * @brief Immutable, reference-counted copy of HTTP headers.
+ *
+ * Snapshots are meant to be shared: once a request's headers are parsed,
+ * freeze them and hand a reference to each thread that needs to read them.
+ * Any number of threads may search and iterate the same snapshot at the
+ * same time, without locking, using the read-only @c http_head it exposes.
+ *
+ * @see http_head_freeze
+ */
+typedef struct http_snapshot http_snapshot;
+
+/*!
+ * @brief Make an immutable copy of HTTP headers.
+ * @param self
+ * @return A snapshot with a single reference, or null if memory allocation
+ *  fails.
+ *
+ * Removed headers are left out and a hash index is built, as with @c
+ * http_head_index, so lookups don't have to scan.  The copy is a single
+ * block taken from @c malloc(), regardless of the allocator used by @a self,
+ * since the last reference may be released by any thread.
+ *
+ * @memberof http_head
+ * @see http_snapshot_release
+ */
+http_snapshot * http_head_freeze (const http_head * self);
+
+/*!
+ * @brief Add a reference to a snapshot.
+ * @param self
+ * @return @a self.
+ *
+ * This is safe to call from any thread that already holds a reference.
+ *
+ * @memberof http_snapshot
+ */
+http_snapshot * http_snapshot_retain (http_snapshot * self);
+
+/*!
+ * @brief Drop a reference to a snapshot, freeing it along with the last one.
+ * @param self
+ *
+ * This is safe to call from any thread.
+ *
+ * @memberof http_snapshot
+ */
+void http_snapshot_release (http_snapshot * self);
+
+/*!
+ * @brief Access the HTTP headers in a snapshot.
+ * @param self
+ * @return Headers that may be searched and iterated until the last
+ *  reference is released.  These must never be modified.
+ *
+ * @memberof http_snapshot
+ */
+const http_head * http_snapshot_head (const http_snapshot * self);
+
+/*!
+ * @brief Precompiled set of HTTP header names to look up together.
+ *
+ * Names are hashed once, when the set is created.  Searching a buffer then
+ * takes a single pass, hashing each header name and probing the set.  A set
+ * is read-only once created, so threads may share it.
+ *
+ * @code
+ *  static const char * fields[] = { "Host", "Content-Length", "Cookie" };
+ *  http_lookup lookup;
+ *  http_lookup_init(&lookup, fields, 3);
+ *  // For each request:
+ *  const char * values[3];
+ *  http_head_lookup(&head, &lookup, values);
+ * @endcode
+ *
+ * @see http_lookup_init
+ * @see http_head_lookup
+ */
+typedef struct http_lookup
+{
+    /*!
+     * @private
+     * @brief Names in the set.
+     */
+    const char * const * fields;
+
+    /*!
+     * @private
+     * @brief Number of names in the set.
+     */
+    size_t count;
+
+    /*!
+     * @private
+     * @brief Open-addressed table of name hashes, using linear probing.
+     */
+    struct http_lookup_slot * slots;
+
+    /*!
+     * @private
+     * @brief Number of slots in the table (a power of 2).
+     */
+    size_t size;
+
+} http_lookup;
+
 /*!
- * @brief Buffer for HTTP headers.
+ * @brief Create a set of HTTP header names.
+ * @param self
+ * @param fields Names in the set.  Must outlive the set.
+ * @param count Number of names in @a fields.
+ * @return 0 if memory allocation fails, else non-zero.
  *
- * The buffer uses a flat representation, all values are stored into a single
- * contiguous chunk of memory.  Operations on the buffer are very limited.
- * Only append, iterate and find operations are supported.
+ * @memberof http_lookup
+ */
+int http_lookup_init (http_lookup * self,
+                      const char * const * fields, size_t count);
+
+/*!
+ * @brief Release memory held by the set.
+ * @param self
  *
- * This representation is convenient for long-lived processes where memory
- * fragmentation is a problem and where there is little need to edit HTTP
- * headers in-place (removing an HTTP header requires seletively copying all
- * other headers to another @c http_head buffer).
+ * @memberof http_lookup
+ */
+void http_lookup_kill (http_lookup * self);
+
+/*!
+ * @brief Search for all HTTP headers named in @a lookup.
+ * @param self
+ * @param lookup Names of the HTTP headers to look for.
+ * @param[out] values Array of pointers, one for each name in @a lookup (in
+ *  the same order), that receives the data of the first header with that
+ *  name or an empty string.
+ * @return The number of names that were found.
  *
- * @see http_head_init
- * @see http_head_kill
- * @see http_head_push
- * @see http_head_find
- * @see http_cursor
+ * @memberof http_head
+ * @see http_head_find_many
  */
-typedef struct http_head
+size_t http_head_lookup (const http_head * self, const http_lookup * lookup,
+                         const char ** values);
+
+/*!
+ * @brief Slab allocator for fixed-capacity @c http_head buffers.
+ *
+ * Buffers are carved out of large slabs and recycled through a free list, so
+ * once the pool has warmed up, acquiring and releasing buffers does not call
+ * @c malloc() or @c free().  The pool is not synchronized: keep one pool per
+ * thread and release buffers on the thread that acquired them.
+ *
+ * @see http_pool_init
+ * @see http_head_pool_acquire
+ * @see http_head_pool_release
+ */
+typedef struct http_pool
 {
     /*!
      * @private
-     * @brief Pointer to the memory chunk containing the headers.
-     * @invariant Points to at least @c size bytes.
-     * @invariant @c data[used] is a null character.
+     * @brief Callbacks that route buffer allocations to the pool.
      */
-    char * data;
+    http_allocator allocator;
 
     /*!
      * @private
-     * @brief Buffer capacity.
-     * @brief Size 
+     * @brief Capacity of each buffer.
      */
     size_t size;
 
     /*!
      * @private
-     * @brief Current buffer usage.
-     * @invariant Less than or equal to @c size.
+     * @brief Number of buffers in each slab.
      */
-    size_t used;
+    size_t count;
 
-} http_head;
+    /*!
+     * @private
+     * @brief Singly linked list of available buffers.
+     */
+    void * free;
+
+    /*!
+     * @private
+     * @brief Singly linked list of slabs.
+     */
+    void * slabs;
+
+} http_pool;
 
 /*!
- * @brief Create an empty buffer with a capacity of @a size bytes.
+ * @brief Create an empty pool.
  * @param self
- * @param size Buffer capacity (fixed).
- * @return 0 if memory allocation fails, else non-zero.
+ * @param size Capacity of each buffer.
+ * @param count Number of buffers to allocate at once when the pool is empty.
  *
- * @memberof http_head
+ * No memory is allocated until the first buffer is acquired.
+ *
+ * @memberof http_pool
  */
-int http_head_init (http_head * self, size_t size);
+void http_pool_init (http_pool * self, size_t size, size_t count);
 
 /*!
- * @brief Release the chunk of memory held by the buffer.
+ * @brief Release all memory held by the pool.
  * @param self
- * @pre @c http_head_init has been called.
- * @post @c http_head_init can be called again to recycle the buffer instance.
+ * @pre All buffers acquired from the pool have been released.
  *
- * @memberof http_head
+ * @memberof http_pool
  */
-void http_head_kill (http_head * self);
+void http_pool_kill (http_pool * self);
 
 /*!
- * @brief Append an HTTP header to the buffer.
+ * @brief Create an empty buffer using memory from a pool.
  * @param self
- * @param field HTTP header name.
- * @param value HTTP header data.
- * @return 0 on failure (e.g. attempted to exceed the buffer capacity), else
- *  non-zero.
+ * @param pool The pool in which to take memory.
+ * @return 0 if memory allocation fails, else non-zero.
+ *
+ * The buffer has a fixed capacity, equal to the size of the pool's buffers.
  *
  * @memberof http_head
+ * @see http_head_pool_release
  */
-int http_head_push (http_head * self, const char * field, const char * value);
+int http_head_pool_acquire (http_head * self, http_pool * pool);
 
 /*!
- * @brief Search for an HTTP header by name.
+ * @brief Return the buffer's memory to the pool it came from.
  * @param self
- * @param field The name of the HTTP header to look for.
- * @return @c An empty (zero-length) string if the header was not found, else a
- *  null-terminated string containing the HTTP header data.
+ * @pre @c http_head_pool_acquire has been called.
  *
- * This method is meant for localized processing of specific HTTP headers (e.g.
- * the content length).  Since it always performs a linear search from the
- * start of the buffer, it is usually more efficient to use an @c http_cursor
- * to iterate over all headers.
+ * This is equivalent to @c http_head_kill.
  *
  * @memberof http_head
- * @see http_cursor
+ * @see http_head_pool_acquire
  */
-const char * http_head_find (const http_head * self, const char * field);
+void http_head_pool_release (http_head * self);
 
 /*!
  * @brief Transaction for partial push operations.
@@ -149,6 +1001,21 @@ typedef struct http_mark
      */
     size_t base;
 
+    /*!
+     * @private
+     * @brief Offset of the header name's null terminator.
+     *
+     * Recorded when switching to header data, so that @c http_head_commit
+     * can validate the header without scanning it again.
+     */
+    size_t field_end;
+
+    /*!
+     * @private
+     * @brief Offset of the first byte of header data.
+     */
+    size_t value_base;
+
     /*!
      * @private
      * @brief 0 while inserting the header name, 1 while inserting data.
@@ -280,6 +1147,12 @@ typedef struct http_cursor
      */
     size_t base;
 
+    /*!
+     * @private
+     * @brief Offset in @c head of the header found by the last call.
+     */
+    size_t last;
+
     /*!
      * @public
      * @brief HTTP header name.
@@ -298,6 +1171,22 @@ typedef struct http_cursor
      */
     const char * value;
 
+    /*!
+     * @public
+     * @brief Length of @c field, in bytes (excluding the null terminator).
+     *
+     * Saves a call to @c strlen() on @c field.
+     */
+    size_t field_size;
+
+    /*!
+     * @public
+     * @brief Length of @c value, in bytes (excluding the null terminator).
+     *
+     * Saves a call to @c strlen() on @c value.
+     */
+    size_t value_size;
+
 } http_cursor;
 
 /*!
@@ -318,14 +1207,338 @@ void http_cursor_init (http_cursor * self, const http_head * head);
  * @return 0 if no more results were available, else 1.
  * @pre @c http_cursor_init was just called or @c http_cursor_next returned 1.
  * @post @c self->field and @c self->value point to an HTTP header's name and
- *  value, respectively.  If the return value is 0, they both point to empty
+ *  value, respectively, and @c self->field_size and @c self->value_size hold
+ *  their lengths.  If the return value is 0, they both point to empty
  *  (zero-length) strings.
  *
+ * The null terminators are located using SSE2 or AVX2 instructions when the
+ * processor supports them.
+ *
  * @memberof http_cursor
  * @see http_cursor_init
  */
 int http_cursor_next (http_cursor * self);
 
+/*!
+ * @brief Fetch the next HTTP header named @a field.
+ * @param self The cursor.
+ * @param field Name of the HTTP header to look for (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @return 0 if no more headers named @a field were available, else 1.
+ * @pre @c http_cursor_init was just called or @c http_cursor_find (or @c
+ *  http_cursor_next) returned 1.
+ * @post Same as @c http_cursor_next.
+ *
+ * Use this to visit all values of a repeated header, in buffer order:
+ * @code
+ *  http_cursor cursor;
+ *  http_cursor_init(&cursor, &head);
+ *  while (http_cursor_find(&cursor, "Via", 3)) {
+ *    // cursor.value holds the next value.
+ *  }
+ * @endcode
+ *
+ * When the buffer is indexed, each call jumps straight to the next match
+ * instead of visiting the headers in between.
+ *
+ * @memberof http_cursor
+ * @see http_head_index
+ */
+int http_cursor_find (http_cursor * self, const char * field, size_t size);
+
+/*!
+ * @brief Join the values of all HTTP headers named @a field.
+ * @param self
+ * @param field Name of the HTTP headers to look for (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @param[out] data Buffer that receives the values, separated by ", " and
+ *  null-terminated.  May be null if @a capacity is 0.
+ * @param capacity Size of @a data, in bytes.
+ * @return The length of the joined values, excluding the null terminator.
+ *  If this is not less than @a capacity, the output was truncated: call
+ *  again with a buffer of at least the returned size plus one.
+ *
+ * This follows RFC 9110, section 5.3.  It is not appropriate for @c
+ * Set-Cookie, whose values may contain commas: use @c http_cursor_find.
+ *
+ * @memberof http_head
+ * @see http_cursor_find
+ */
+size_t http_head_coalesce (const http_head * self, const char * field,
+                           size_t size, char * data, size_t capacity);
+
+/*!
+ * @brief Parse the first HTTP header named @a field as an unsigned integer.
+ * @param self
+ * @param field Name of the HTTP header to look for (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @param[out] value Receives the number, if the header was found and valid.
+ * @return 1 on success, 0 if the header was not found, or -1 if its data is
+ *  not a (non-empty) sequence of digits that fits in 64 bits.
+ *
+ * Suits headers like @c Content-Length or @c Max-Forwards.  The result is
+ * kept in a small per-head cache, so asking again skips both the lookup and
+ * the parsing.  Pushing a header with the same name, or removing, replacing
+ * or cancelling headers drops cached results.  This makes the accessor
+ * modify @a self, even though the headers are left as-is.
+ *
+ * @memberof http_head
+ */
+int http_head_get_u64 (http_head * self, const char * field, size_t size,
+                       unsigned long long * value);
+
+/*!
+ * @brief Parse the first HTTP header named @a field as a date.
+ * @param self
+ * @param field Name of the HTTP header to look for (case-insensitive).
+ * @param size Length of @a field, in bytes.
+ * @param[out] value Receives the date, if the header was found and valid.
+ * @return 1 on success, 0 if the header was not found, or -1 if its data is
+ *  not a valid date.
+ *
+ * Suits headers like @c Date, @c Last-Modified or @c If-Modified-Since.  All
+ * three formats from RFC 9110, section 5.6.7 are accepted: IMF-fixdate
+ * (e.g. @c "Sun, 06 Nov 1994 08:49:37 GMT"), as well as the obsolete RFC 850
+ * and @c asctime() formats.  Results are cached like for
+ * @c http_head_get_u64.
+ *
+ * @memberof http_head
+ * @see http_head_get_u64
+ */
+int http_head_get_date (http_head * self, const char * field, size_t size,
+                        time_t * value);
+
+/*!
+ * @brief Incremental parser for HTTP/1.x headers.
+ *
+ * The parser accepts the header lines that follow the request or status line
+ * (e.g. @c "Host: example.com\r\n"), in chunks of any size, and pushes them
+ * directly into an @c http_head.  It stops right after the blank line that
+ * ends the headers.
+ *
+ * Recommended use:
+ * @code
+ *  http_parser parser;
+ *  http_parser_init(&parser, &head);
+ *  while (!http_parser_done(&parser))
+ *  {
+ *    size = recv(socket, data, sizeof(data), 0);
+ *    used = http_parser_feed(&parser, data, size);
+ *    if (http_parser_fail(&parser)) {
+ *      // Bad request.
+ *    }
+ *    // When done, data[used..size) holds the start of the body.
+ *  }
+ * @endcode
+ *
+ * Leading and trailing whitespace is stripped from header data.  Obsolete
+ * line folding, whitespace before the colon and null characters are rejected.
+ * Bare line feeds are accepted as line terminators.
+ *
+ * @see http_parser_init
+ * @see http_parser_feed
+ */
+typedef struct http_parser
+{
+    /*!
+     * @private
+     * @brief Buffer into which headers are pushed.
+     */
+    http_head * head;
+
+    /*!
+     * @private
+     * @brief Partial push for the header being parsed.
+     */
+    http_mark mark;
+
+    /*!
+     * @private
+     * @brief Current state of the parser.
+     */
+    int state;
+
+    /*!
+     * @private
+     * @brief Amount of trailing whitespace in the header data so far.
+     */
+    size_t space;
+
+} http_parser;
+
+/*!
+ * @brief Prepare to parse headers into @a head.
+ * @param self
+ * @param head Buffer that receives the headers.
+ *
+ * @memberof http_parser
+ */
+void http_parser_init (http_parser * self, http_head * head);
+
+/*!
+ * @brief Parse a chunk of data.
+ * @param self
+ * @param data Data received from the peer.
+ * @param size Number of valid bytes starting at @a data.
+ * @return The number of bytes consumed.  This is less than @a size only if
+ *  parsing completed or failed within this chunk.
+ *
+ * Line terminators and colons are located using SSE2 or AVX2 instructions
+ * when the processor supports them.  On failure, the header being parsed is
+ * removed from the buffer.  Once parsing has completed or failed, further
+ * calls consume nothing.
+ *
+ * @memberof http_parser
+ * @see http_parser_done
+ * @see http_parser_fail
+ */
+size_t http_parser_feed (http_parser * self, const char * data, size_t size);
+
+/*!
+ * @brief Check if the blank line ending the headers has been parsed.
+ * @param self
+ * @return non-zero if parsing has completed, else 0.
+ *
+ * @memberof http_parser
+ */
+int http_parser_done (const http_parser * self);
+
+/*!
+ * @brief Check if the data was rejected.
+ * @param self
+ * @return non-zero if parsing failed (e.g. the data is malformed or exceeds
+ *  the buffer capacity), else 0.
+ *
+ * @memberof http_parser
+ */
+int http_parser_fail (const http_parser * self);
+
+/*!
+ * @brief Process-wide counters, for monitoring.
+ *
+ * Counting is compiled out unless the library is built with the @c
+ * CHTTP_STATS CMake option, in which case each counter is updated with a
+ * single relaxed atomic operation.  Counters are global rather than per
+ * head, so that @c http_head keeps the same size either way.
+ *
+ * @see http_stats_read
+ */
+typedef struct http_stats
+{
+    /*!
+     * @brief Number of successful partial pushes, for names or data.
+     */
+    unsigned long long pushes;
+
+    /*!
+     * @brief Number of bytes copied by these pushes.
+     */
+    unsigned long long bytes;
+
+    /*!
+     * @brief Number of operations that failed because the buffer was full
+     *  (or could not grow).
+     */
+    unsigned long long overflows;
+
+    /*!
+     * @brief Number of operations that failed on invalid input (e.g. an
+     *  empty header name or a stale mark).
+     */
+    unsigned long long rejects;
+
+    /*!
+     * @brief Number of headers committed.
+     */
+    unsigned long long commits;
+
+    /*!
+     * @brief Number of partial pushes cancelled.
+     */
+    unsigned long long cancels;
+
+    /*!
+     * @brief Number of index slots or headers examined by lookups.
+     */
+    unsigned long long probes;
+
+    /*!
+     * @brief Number of @c http_head_find (and related) calls that found a
+     *  header.
+     */
+    unsigned long long hits;
+
+    /*!
+     * @brief Number of @c http_head_find (and related) calls that found
+     *  nothing.
+     */
+    unsigned long long misses;
+
+    /*!
+     * @brief Highest buffer usage after a commit, in bytes.
+     */
+    unsigned long long peak_used;
+
+    /*!
+     * @brief Highest buffer usage after a commit, in thousandths of the
+     *  buffer capacity.
+     */
+    unsigned long long peak_fill;
+
+} http_stats;
+
+/*!
+ * @brief Kinds of failures reported to a @c http_stats_hook.
+ */
+typedef enum http_stats_event
+{
+    /*!
+     * @brief The buffer is full, or could not grow.
+     */
+    HTTP_STATS_OVERFLOW,
+
+    /*!
+     * @brief The input is invalid.
+     */
+    HTTP_STATS_REJECT
+
+} http_stats_event;
+
+/*!
+ * @brief Callback for failures, see @c http_stats_observe.
+ * @param context Pointer passed to @c http_stats_observe.
+ * @param head Buffer on which the operation failed.
+ * @param event Why the operation failed.
+ */
+typedef void (*http_stats_hook)(void * context, const http_head * head,
+                                http_stats_event event);
+
+/*!
+ * @brief Read all counters.
+ * @param[out] stats Receives the counters, which are all 0 unless
+ *  counting is enabled.
+ * @return non-zero if the library was built with counting enabled, else 0.
+ *
+ * Each counter is read atomically, but not all of them at once.
+ */
+int http_stats_read (http_stats * stats);
+
+/*!
+ * @brief Set all counters to 0.
+ */
+void http_stats_reset (void);
+
+/*!
+ * @brief Register a callback for failures.
+ * @param hook Callback, or null to stop observing.
+ * @param context Passed to @a hook as is.
+ *
+ * When counting is enabled, the callback runs on the thread where the
+ * failure occurs, right after it is counted, so it should be cheap.  Set it
+ * up before using the library from several threads.
+ */
+void http_stats_observe (http_stats_hook hook, void * context);
+
 #ifdef __cplusplus
 }
 #endif
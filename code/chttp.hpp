@@ -33,14 +33,442 @@
 
 #include "chttp.h"
 #include <cstddef>
+#include <ctime>
+#include <iosfwd>
+#include <iterator>
 #include <memory>
+#include <new>
 #include <string>
 
+#if (__cplusplus >= 201103L) || \
+    (defined(_MSVC_LANG) && (_MSVC_LANG >= 201103L))
+#   define CHTTP_CXX11 1
+#endif
+
+#if (__cplusplus >= 201703L) || \
+    (defined(_MSVC_LANG) && (_MSVC_LANG >= 201703L))
+#   define CHTTP_STRING_VIEW 1
+#   define CHTTP_BASIC_HEAD 1
+#   include <array>
+#   include <initializer_list>
+#   include <string_view>
+#   include <utility>
+#endif
+
 /*!
  * @brief C++ wrappers for the `chttp` library.
  */
 namespace http {
 
+    /*!
+     * @brief Read-only reference to a sequence of characters.
+     *
+     * Views let you inspect HTTP headers in place, without allocating a @c
+     * std::string.  They convert implicitly to @c std::string (which copies)
+     * and, when compiling as C++17, to @c std::string_view.
+     *
+     * @warning Views into a @c Head are invalidated when the buffer is
+     *  modified or destroyed.
+     */
+    class View
+    {
+        /* data. */
+    private:
+        const char * myData;
+        std::size_t mySize;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Create an empty view.
+         */
+        View ();
+
+        /*!
+         * @brief Refer to a null-terminated string.
+         */
+        View (const char * data);
+
+        /*!
+         * @brief Refer to @a size characters starting at @a data.
+         */
+        View (const char * data, std::size_t size);
+
+        /*!
+         * @brief Refer to the contents of @a data.
+         */
+        View (const std::string& data);
+
+#if defined(CHTTP_STRING_VIEW)
+        /*!
+         * @brief Refer to the contents of @a data.
+         */
+        View (std::string_view data);
+#endif
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Access the first character.
+         * @warning The characters are not necessarily null-terminated.
+         */
+        const char * data () const;
+
+        /*!
+         * @brief Number of characters.
+         */
+        std::size_t size () const;
+
+        /*!
+         * @brief Check if the view has no characters.
+         */
+        bool empty () const;
+
+        /*!
+         * @brief Iterate from the first character.
+         */
+        const char * begin () const;
+
+        /*!
+         * @brief Iterate up to the last character.
+         */
+        const char * end () const;
+
+        /*!
+         * @brief Access the character at position @a i.
+         */
+        char operator[] (std::size_t i) const;
+
+        /*!
+         * @brief Copy the characters to a new string.
+         */
+        operator std::string () const;
+
+#if defined(CHTTP_STRING_VIEW)
+        /*!
+         * @brief Convert to a standard view of the same characters.
+         */
+        operator std::string_view () const;
+#endif
+    };
+
+    /*!
+     * @brief Compare two views, character by character.
+     */
+    bool operator== (const View& lhs, const View& rhs);
+
+    /*!
+     * @brief Compare two views, character by character.
+     */
+    bool operator!= (const View& lhs, const View& rhs);
+
+    /*!
+     * @brief Write the characters to @a stream.
+     */
+    std::ostream& operator<< (std::ostream& stream, const View& view);
+
+#if defined(CHTTP_CXX11)
+    /*!
+     * @brief HTTP header name, hashed at compile time.
+     *
+     * Lookups by key skip measuring and hashing the name, and go straight to
+     * the slot when the buffer has an index:
+     * @code
+     *  using namespace http::literals;
+     *  http::View type = head.find("content-type"_h);
+     *  http::View host = head.find(http::hdr::host);
+     * @endcode
+     *
+     * @see http_head_find_hashed
+     */
+    class Key
+    {
+        /* data. */
+    private:
+        const char * myData;
+        std::size_t mySize;
+        unsigned int myHash;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Refer to @a size characters starting at @a data.
+         * @warning The characters must outlive the key.
+         */
+        constexpr Key (const char * data, std::size_t size)
+            : myData(data), mySize(size), myHash(hash(data, size))
+        {
+        }
+
+        /*!
+         * @brief Refer to a string literal.
+         */
+        template<std::size_t N>
+        constexpr Key (const char (&data)[N])
+            : myData(data), mySize(N-1), myHash(hash(data, N-1))
+        {
+        }
+
+        /* class methods. */
+    private:
+        static constexpr unsigned int fold (char c)
+        {
+            return (static_cast<unsigned char>(
+                ((c >= 'A') && (c <= 'Z'))? (c + ('a'-'A')) : c));
+        }
+
+    public:
+        /*!
+         * @brief Same as @c http_header_hash, usable in constant expressions.
+         */
+        static constexpr unsigned int hash (const char * data,
+                                            std::size_t size,
+                                            unsigned int seed=2166136261u)
+        {
+            return ((size == 0)? seed : hash(data+1, size-1,
+                (seed ^ fold(data[0])) * 16777619u));
+        }
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Access the first character.
+         * @warning The characters are not necessarily null-terminated.
+         */
+        constexpr const char * data () const
+        {
+            return (myData);
+        }
+
+        /*!
+         * @brief Number of characters.
+         */
+        constexpr std::size_t size () const
+        {
+            return (mySize);
+        }
+
+        /*!
+         * @brief Hash of the name, as computed by @c http_header_hash.
+         */
+        constexpr unsigned int hashed () const
+        {
+            return (myHash);
+        }
+    };
+
+    /*!
+     * @brief User-defined literals for HTTP header names.
+     */
+    namespace literals {
+
+        /*!
+         * @brief Hash a string literal at compile time, as in @c "host"_h.
+         */
+        constexpr Key operator""_h (const char * data, std::size_t size)
+        {
+            return (Key(data, size));
+        }
+
+    }
+
+    /*!
+     * @brief Keys for the well-known HTTP header names.
+     *
+     * @see http_header
+     */
+    namespace hdr {
+
+        constexpr Key accept("Accept");
+        constexpr Key accept_charset("Accept-Charset");
+        constexpr Key accept_encoding("Accept-Encoding");
+        constexpr Key accept_language("Accept-Language");
+        constexpr Key accept_ranges("Accept-Ranges");
+        constexpr Key access_control_allow_credentials(
+            "Access-Control-Allow-Credentials");
+        constexpr Key access_control_allow_headers(
+            "Access-Control-Allow-Headers");
+        constexpr Key access_control_allow_methods(
+            "Access-Control-Allow-Methods");
+        constexpr Key access_control_allow_origin(
+            "Access-Control-Allow-Origin");
+        constexpr Key access_control_expose_headers(
+            "Access-Control-Expose-Headers");
+        constexpr Key access_control_max_age("Access-Control-Max-Age");
+        constexpr Key access_control_request_headers(
+            "Access-Control-Request-Headers");
+        constexpr Key access_control_request_method(
+            "Access-Control-Request-Method");
+        constexpr Key age("Age");
+        constexpr Key allow("Allow");
+        constexpr Key alt_svc("Alt-Svc");
+        constexpr Key authorization("Authorization");
+        constexpr Key cache_control("Cache-Control");
+        constexpr Key connection("Connection");
+        constexpr Key content_disposition("Content-Disposition");
+        constexpr Key content_encoding("Content-Encoding");
+        constexpr Key content_language("Content-Language");
+        constexpr Key content_length("Content-Length");
+        constexpr Key content_location("Content-Location");
+        constexpr Key content_range("Content-Range");
+        constexpr Key content_security_policy("Content-Security-Policy");
+        constexpr Key content_type("Content-Type");
+        constexpr Key cookie("Cookie");
+        constexpr Key date("Date");
+        constexpr Key etag("ETag");
+        constexpr Key expect("Expect");
+        constexpr Key expires("Expires");
+        constexpr Key forwarded("Forwarded");
+        constexpr Key from("From");
+        constexpr Key host("Host");
+        constexpr Key if_match("If-Match");
+        constexpr Key if_modified_since("If-Modified-Since");
+        constexpr Key if_none_match("If-None-Match");
+        constexpr Key if_range("If-Range");
+        constexpr Key if_unmodified_since("If-Unmodified-Since");
+        constexpr Key keep_alive("Keep-Alive");
+        constexpr Key last_modified("Last-Modified");
+        constexpr Key link("Link");
+        constexpr Key location("Location");
+        constexpr Key max_forwards("Max-Forwards");
+        constexpr Key origin("Origin");
+        constexpr Key pragma("Pragma");
+        constexpr Key proxy_authenticate("Proxy-Authenticate");
+        constexpr Key proxy_authorization("Proxy-Authorization");
+        constexpr Key proxy_connection("Proxy-Connection");
+        constexpr Key range("Range");
+        constexpr Key referer("Referer");
+        constexpr Key refresh("Refresh");
+        constexpr Key retry_after("Retry-After");
+        constexpr Key server("Server");
+        constexpr Key set_cookie("Set-Cookie");
+        constexpr Key strict_transport_security("Strict-Transport-Security");
+        constexpr Key te("TE");
+        constexpr Key trailer("Trailer");
+        constexpr Key transfer_encoding("Transfer-Encoding");
+        constexpr Key upgrade("Upgrade");
+        constexpr Key upgrade_insecure_requests("Upgrade-Insecure-Requests");
+        constexpr Key user_agent("User-Agent");
+        constexpr Key vary("Vary");
+        constexpr Key via("Via");
+        constexpr Key www_authenticate("WWW-Authenticate");
+        constexpr Key x_content_type_options("X-Content-Type-Options");
+        constexpr Key x_forwarded_for("X-Forwarded-For");
+        constexpr Key x_forwarded_host("X-Forwarded-Host");
+        constexpr Key x_forwarded_proto("X-Forwarded-Proto");
+        constexpr Key x_frame_options("X-Frame-Options");
+        constexpr Key x_real_ip("X-Real-IP");
+        constexpr Key x_request_id("X-Request-ID");
+        constexpr Key x_requested_with("X-Requested-With");
+
+    }
+#endif
+
+    /*!
+     * @brief Slab allocator for fixed-capacity buffers.
+     *
+     * @see http_pool
+     */
+    class Pool
+    {
+        /* data. */
+    private:
+        ::http_pool myBackend;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Create an empty pool.
+         * @param size Capacity of each buffer.
+         * @param count Number of buffers to allocate at once.
+         */
+        Pool (std::size_t size, std::size_t count);
+
+        /*!
+         * @brief Release all memory held by the pool.
+         * @pre All @c Head objects using the pool have been destroyed.
+         */
+        ~Pool ();
+
+    private:
+        Pool (const Pool&);
+        Pool& operator= (const Pool&);
+
+        /* methods. */
+    public:
+        /*!
+         * @internal
+         * @brief Access the native representation.
+         * @return The C structure that backs the object.
+         */
+        ::http_pool& backend ();
+    };
+
+    class Values;
+    class Snapshot;
+#if defined(CHTTP_BASIC_HEAD)
+    template<std::size_t N> class BasicHead;
+#endif
+
+    /*!
+     * @brief Precompiled set of @a N HTTP header names.
+     *
+     * @code
+     *  static const char * fields[] = { "Host", "Content-Length" };
+     *  static const http::Lookup<2> lookup(fields);
+     *  // For each request:
+     *  http::View values[2];
+     *  head.find(lookup, values);
+     * @endcode
+     *
+     * @see http_lookup
+     */
+    template<std::size_t N>
+    class Lookup
+    {
+        /* data. */
+    private:
+        ::http_lookup myBackend;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Hash the names in @a fields.
+         * @param fields Names in the set.  Must outlive the set.
+         * @exception std::bad_alloc Could not allocate the set.
+         */
+        explicit Lookup (const char * const (&fields)[N])
+        {
+            if (::http_lookup_init(&myBackend, fields, N) == 0) {
+                throw (std::bad_alloc());
+            }
+        }
+
+        /*!
+         * @brief Release memory held by the set.
+         */
+        ~Lookup ()
+        {
+            ::http_lookup_kill(&myBackend);
+        }
+
+    private:
+        Lookup (const Lookup&);
+        Lookup& operator= (const Lookup&);
+
+        /* methods. */
+    public:
+        /*!
+         * @internal
+         * @brief Access the native representation.
+         * @return The C structure that backs the object.
+         */
+        const ::http_lookup& backend () const
+        {
+            return (myBackend);
+        }
+    };
+
     /*!
      * @brief Buffer for HTTP headers.
      *
@@ -61,11 +489,90 @@ namespace http {
          */
         Head (std::size_t size);
 
+        /*!
+         * @brief Create an empty buffer that grows as needed.
+         * @param size Initial buffer capacity.
+         * @param limit Maximum buffer capacity.
+         * @param allocator Memory management callbacks, or null to use the
+         *  default allocator.
+         * @exception std::bad_alloc Could not acquire @a size bytes of memory.
+         *
+         * @see http_head_init_ex
+         */
+        Head (std::size_t size, std::size_t limit,
+              const ::http_allocator * allocator=0);
+
+        /*!
+         * @brief Create an empty buffer using memory from a pool.
+         * @param pool Pool in which to take memory.  Must outlive the buffer.
+         * @exception std::bad_alloc Could not acquire memory.
+         *
+         * @see http_head_pool_acquire
+         */
+        explicit Head (Pool& pool);
+
+#if defined(CHTTP_CXX11)
+        /*!
+         * @brief Take over the headers in @a other, without copying them.
+         * @param other Buffer that gives up its headers.  It holds no memory
+         *  afterwards, so it may only be destroyed, assigned to or given a
+         *  buffer with @c adopt().
+         * @exception std::bad_alloc @a other keeps its headers in inline
+         *  memory, and they could not be copied out of it.
+         * @warning Cursors, parsers and views on @a other are invalidated.
+         *
+         * @see http_head_move
+         */
+        Head (Head&& other)
+        {
+            if (::http_head_move(&myBackend, &other.myBackend) == 0) {
+                throw (std::bad_alloc());
+            }
+        }
+#endif
+
         /*!
          * @brief Release memory acquired for buffering.
          */
         ~Head ();
 
+    private:
+        Head (const Head&);
+        Head& operator= (const Head&);
+
+        /*!
+         * @internal
+         * @brief Make a deep copy of @a other, for @c clone().
+         */
+        explicit Head (const ::http_head& other);
+
+        /*!
+         * @internal
+         * @brief Call a C++ @a Filter through @c http_head_filter.
+         */
+        template<typename Filter>
+        static int filter (void * context, const char * field,
+                           std::size_t size, const char * value,
+                           std::size_t value_size)
+        {
+            return ((*static_cast<Filter*>(context))(
+                View(field, size), View(value, value_size)));
+        }
+
+    protected:
+        /*!
+         * @brief Create an empty buffer in memory owned by a derived class.
+         * @param data Memory in which to store headers.
+         * @param size Size of @a data, in bytes.
+         * @param limit Maximum buffer capacity.
+         * @param allocator Memory management callbacks used once the headers
+         *  outgrow @a data, or null to use the default allocator.
+         *
+         * @see http_head_init_storage
+         */
+        Head (char * data, std::size_t size, std::size_t limit,
+              const ::http_allocator * allocator);
+
         /* methods. */
     public:
         /*!
@@ -82,6 +589,128 @@ namespace http {
          */
         const ::http_head& backend () const;
 
+#if defined(CHTTP_CXX11)
+        /*!
+         * @brief Take over the headers in @a other, dropping the current ones.
+         * @exception std::bad_alloc @a other keeps its headers in inline
+         *  memory, and they could not be copied out of it.
+         *
+         * @see http_head_move
+         */
+        Head& operator= (Head&& other)
+        {
+            ::http_head head;
+            if (this != &other) {
+                if (::http_head_move(&head, &other.myBackend) == 0) {
+                    throw (std::bad_alloc());
+                }
+                ::http_head_kill(&myBackend);
+                myBackend = head;
+            }
+            return (*this);
+        }
+
+        /*!
+         * @brief Make a deep copy of the headers.
+         * @return A buffer with the same headers, capacity, limit, allocator
+         *  and options.  It has an index if this buffer has one.
+         * @exception std::bad_alloc Could not acquire memory.
+         */
+        Head clone () const
+        {
+            return (Head(myBackend));
+        }
+#endif
+
+        /*!
+         * @brief Append all HTTP headers in @a other.
+         * @param other HTTP headers to copy.  Must be a different buffer.
+         * @return @c false if the headers do not fit, in which case nothing
+         *  is appended, else @c true.
+         *
+         * @see http_head_append_all
+         */
+        bool append (const Head& other);
+
+        /*!
+         * @brief Append the HTTP headers in @a other, except some.
+         * @param other HTTP headers to copy.  Must be a different buffer.
+         * @param fields Names of the HTTP headers to leave out.
+         * @return @c false if the headers do not fit, in which case nothing
+         *  is appended, else @c true.
+         *
+         * @see http_head_append_except
+         */
+        template<std::size_t N>
+        bool append_except (const Head& other,
+                            const char * const (&fields)[N])
+        {
+            return (::http_head_append_except(&myBackend,
+                &other.myBackend, fields, N) != 0);
+        }
+
+        /*!
+         * @brief Append the HTTP headers in @a other selected by @a filter.
+         * @param other HTTP headers to copy.  Must be a different buffer.
+         * @param filter Called as @c filter(field,value) with two @c View
+         *  objects, returning an @c int as for @c http_head_filter.  It must
+         *  not throw.
+         * @return @c false if the headers do not fit, in which case nothing
+         *  is appended, else @c true.
+         *
+         * @see http_head_append_if
+         */
+        template<typename Filter>
+        bool append_if (const Head& other, Filter filter)
+        {
+            return (::http_head_append_if(&myBackend, &other.myBackend,
+                &Head::filter<Filter>, &filter) != 0);
+        }
+
+        /*!
+         * @brief Exchange headers with @a other.
+         * @exception std::bad_alloc Either buffer keeps its headers in inline
+         *  memory, and they could not be copied out of it.
+         */
+        void swap (Head& other);
+
+        /*!
+         * @brief Take over a buffer that already holds HTTP headers.
+         * @param data Memory acquired from this buffer's allocator, e.g. by
+         *  @c release().
+         * @param size Capacity of @a data, in bytes.
+         * @param used Number of bytes used by the headers.
+         * @return @c false if the headers are malformed, in which case @a data
+         *  still belongs to the caller, else @c true.
+         *
+         * The current headers are dropped, but the options are kept and
+         * applied to the adopted headers (e.g. names are folded to lowercase).
+         *
+         * @see http_head_adopt
+         */
+        bool adopt (char * data, std::size_t size, std::size_t used);
+
+        /*!
+         * @brief Give up the memory that holds the headers.
+         * @param[out] size Receives the capacity of the memory, in bytes.
+         * @param[out] used Receives the number of bytes used by the headers.
+         * @return The memory, which the caller must return to the allocator
+         *  (or pass to @c adopt()), or null if the buffer held no memory.
+         * @exception std::bad_alloc The headers are kept in inline memory,
+         *  and they could not be copied out of it.
+         * @post The buffer holds no memory, as after a move.
+         *
+         * @see http_head_release
+         */
+        char * release (std::size_t& size, std::size_t& used);
+
+        /*!
+         * @brief Remove all HTTP headers, keeping the memory for reuse.
+         *
+         * @see http_head_reset
+         */
+        void reset ();
+
         /*!
         * @brief Append an HTTP header to the buffer.
         * @param field HTTP header name.
@@ -92,19 +721,266 @@ namespace http {
         bool push (const std::string& field, const std::string& value);
 
         /*!
-        * @brief Search for an HTTP header by name.
-        * @param field The name of the HTTP header to look for.
-        * @return @c An empty (zero-length) string if the header was not found,
-        *  else a string containing the HTTP header data.
-        *
-        * This method is meant for localized processing of specific HTTP
-        * headers (e.g. the content length).  Since it always performs a linear
-        * search from the start of the buffer, it is usually more efficient to
-        * use a @c Cursor to iterate over all headers.
-        *
-        * @see Cursor
-        */
-        std::string find (const std::string& field) const;
+         * @brief Append an HTTP header to the buffer, without allocating.
+         * @param field HTTP header name.
+         * @param value HTTP header data.
+         * @return @c false on failure (e.g. attempted to exceed the buffer
+         *  capacity), else @c true.
+         */
+        bool push (const char * field, const char * value);
+
+        /*!
+         * @brief Append an HTTP header to the buffer, without allocating.
+         * @param field HTTP header name.
+         * @param value HTTP header data.
+         * @return @c false on failure (e.g. attempted to exceed the buffer
+         *  capacity), else @c true.
+         */
+        bool push (View field, View value);
+
+        /*!
+        * @brief Search for an HTTP header by name.
+        * @param field The name of the HTTP header to look for.
+        * @return @c An empty (zero-length) string if the header was not found,
+        *  else a string containing the HTTP header data.
+        *
+        * This method is meant for localized processing of specific HTTP
+        * headers (e.g. the content length).  Unless @c index() has been
+        * called, it performs a linear search from the start of the buffer, so
+        * it is usually more efficient to use a @c Cursor to iterate over all
+        * headers.
+        *
+        * @see Cursor
+        * @see index()
+        */
+        std::string find (const std::string& field) const;
+
+        /*!
+         * @brief Search for an HTTP header by name, without allocating.
+         * @param field The name of the HTTP header to look for.
+         * @return @c An empty view if the header was not found, else a view
+         *  of the HTTP header data (which is null-terminated).
+         *
+         * @see http_head_findn
+         */
+        View find (View field) const;
+
+        /*!
+         * @brief Search for an HTTP header by name, without allocating.
+         * @param field The name of the HTTP header to look for.
+         * @return @c An empty view if the header was not found, else a view
+         *  of the HTTP header data (which is null-terminated).
+         */
+        View find (const char * field) const;
+
+        /*!
+         * @brief Search for a well-known HTTP header.
+         * @param id Identifier of the HTTP header to look for.
+         * @return @c An empty view if the header was not found, else a view
+         *  of the HTTP header data.
+         *
+         * @see http_head_find_id
+         */
+        View find (::http_header id) const;
+
+#if defined(CHTTP_CXX11)
+        /*!
+         * @brief Search for an HTTP header by a name hashed in advance.
+         * @param key The name of the HTTP header to look for.
+         * @return @c An empty view if the header was not found, else a view
+         *  of the HTTP header data.
+         *
+         * @see http_head_find_hashed
+         */
+        View find (const Key& key) const
+        {
+            return (::http_head_find_hashed(&myBackend,
+                key.data(), key.size(), key.hashed()));
+        }
+#endif
+
+        /*!
+         * @brief Enumerate all values of a (possibly repeated) HTTP header.
+         * @param field The name of the HTTP header to look for.  The
+         *  characters must outlive the returned range.
+         * @return A range over the values, which are located lazily.
+         *
+         * @see http_cursor_find
+         */
+        Values find_all (View field) const;
+
+        /*!
+         * @brief Search for several HTTP headers in a single pass.
+         * @param fields Names of the HTTP headers to look for.
+         * @param[out] values Receives the data of the first header with each
+         *  name, or an empty view.
+         * @return The number of names that were found.
+         *
+         * @see http_head_find_many
+         */
+        template<std::size_t N>
+        std::size_t find (const char * const (&fields)[N],
+                          View (&values)[N]) const
+        {
+            const char * data[N];
+            const std::size_t found =
+                ::http_head_find_many(&myBackend, fields, N, data);
+            for (std::size_t i = 0; i < N; ++i) {
+                values[i] = View(data[i]);
+            }
+            return (found);
+        }
+
+        /*!
+         * @brief Search for all HTTP headers in a precompiled set.
+         * @param lookup Names of the HTTP headers to look for.
+         * @param[out] values Receives the data of the first header with each
+         *  name, or an empty view.
+         * @return The number of names that were found.
+         *
+         * @see http_head_lookup
+         */
+        template<std::size_t N>
+        std::size_t find (const Lookup<N>& lookup, View (&values)[N]) const
+        {
+            const char * data[N];
+            const std::size_t found =
+                ::http_head_lookup(&myBackend, &lookup.backend(), data);
+            for (std::size_t i = 0; i < N; ++i) {
+                values[i] = View(data[i]);
+            }
+            return (found);
+        }
+
+        /*!
+         * @brief Parse the first HTTP header named @a field as a number.
+         * @param field The name of the HTTP header to look for.
+         * @param[out] value Receives the number on success.
+         * @return 1 on success, 0 if the header was not found, or -1 if it
+         *  is malformed.
+         *
+         * @see http_head_get_u64
+         */
+        int get_u64 (View field, unsigned long long& value);
+
+        /*!
+         * @brief Parse the first HTTP header named @a field as a date.
+         * @param field The name of the HTTP header to look for.
+         * @param[out] value Receives the date on success.
+         * @return 1 on success, 0 if the header was not found, or -1 if it
+         *  is malformed.
+         *
+         * @see http_head_get_date
+         */
+        int get_date (View field, std::time_t& value);
+
+        /*!
+         * @brief Remove all HTTP headers named @a field.
+         * @param field The name of the HTTP headers to remove.
+         * @return The number of headers removed.
+         *
+         * @see http_head_remove
+         */
+        std::size_t remove (View field);
+
+        /*!
+         * @brief Set the data of the HTTP header named @a field.
+         * @param field The name of the HTTP header to set.
+         * @param value New HTTP header data.
+         * @return @c false on failure (e.g. attempted to exceed the buffer
+         *  capacity), else @c true.
+         *
+         * @see http_head_replace
+         */
+        bool replace (View field, View value);
+
+        /*!
+         * @brief Reclaim space held by removed HTTP headers.
+         *
+         * @see http_head_compact
+         */
+        void compact ();
+
+        /*!
+         * @brief Change options for subsequent pushes.
+         * @param options Combination of @c HTTP_HEAD_TOKENS and
+         *  @c HTTP_HEAD_LOWERCASE, or 0.
+         *
+         * @see http_head_configure
+         */
+        void configure (unsigned int options);
+
+        /*!
+         * @brief Make an immutable copy that threads can share.
+         * @return A snapshot of the current headers.
+         * @exception std::bad_alloc Could not allocate the snapshot.
+         *
+         * @see http_head_freeze
+         */
+        Snapshot freeze () const;
+
+        /*!
+         * @brief Attach a hash index over header names to the buffer.
+         * @exception std::bad_alloc Could not allocate the index.
+         *
+         * @see http_head_index
+         */
+        void index ();
+    };
+
+    /*!
+     * @brief Exchange the headers in @a lhs and @a rhs.
+     *
+     * @see Head::swap
+     */
+    void swap (Head& lhs, Head& rhs);
+
+    /*!
+     * @internal
+     * @brief Inline memory for a @c SmallHead.
+     *
+     * This is a base class so that the memory exists before @c Head uses it.
+     */
+    template<std::size_t N>
+    class Storage
+    {
+        /* data. */
+    protected:
+        char myStorage[N];
+    };
+
+    /*!
+     * @brief Buffer for HTTP headers that starts out in @a N inline bytes.
+     *
+     * Small requests never touch the heap.  When headers outgrow the inline
+     * memory, they move to memory from the allocator and the buffer keeps
+     * growing up to the limit.
+     * @code
+     *  http::SmallHead<512> head(64*1024);
+     *  http::Parser parser(head);
+     * @endcode
+     *
+     * @see http_head_init_storage
+     */
+    template<std::size_t N>
+    class SmallHead :
+        private Storage<N>, public Head
+    {
+        /* construction. */
+    public:
+        /*!
+         * @brief Create an empty buffer in inline memory.
+         * @param limit Maximum buffer capacity.  The buffer has a fixed
+         *  capacity if this is less than or equal to @a N.
+         * @param allocator Memory management callbacks used once the
+         *  headers outgrow the inline memory, or null to use the default
+         *  allocator.
+         */
+        explicit SmallHead (std::size_t limit=N,
+                            const ::http_allocator * allocator=0)
+            : Head(Storage<N>::myStorage, N, limit, allocator)
+        {
+        }
     };
 
     /*!
@@ -148,6 +1024,28 @@ namespace http {
          */
         explicit Cursor (const Head& head);
 
+        /*!
+         * @brief Prepare for iteration over @a snapshot.
+         * @param snapshot HTTP headers over which to iterate.
+         *
+         * @warning You should call @c next() right after this.
+         */
+        explicit Cursor (const Snapshot& snapshot);
+
+#if defined(CHTTP_BASIC_HEAD)
+        /*!
+         * @brief Prepare for iteration over @a head.
+         * @param head HTTP headers over which to iterate.
+         *
+         * @warning You should call @c next() right after this.
+         */
+        template<std::size_t N>
+        explicit Cursor (const BasicHead<N>& head)
+        {
+            ::http_cursor_init(&myBackend, &head.backend());
+        }
+#endif
+
         /* methods. */
     public:
         /*!
@@ -178,6 +1076,564 @@ namespace http {
          * @see field()
          */
         std::string value () const;
+
+        /*!
+         * @brief Obtains the current HTTP header's name, without allocating.
+         * @return A view of the current HTTP header's name.
+         * @pre @c next() just returned @c true.
+         */
+        View field_view () const;
+
+        /*!
+         * @brief Obtains the current HTTP header's data, without allocating.
+         * @return A view of the current HTTP header's data.
+         * @pre @c next() just returned @c true.
+         */
+        View value_view () const;
+
+        /*!
+         * @brief Locates the next HTTP header named @a field.
+         * @param field The name of the HTTP header to look for.
+         * @return @c false if there are no more such headers, else @c true.
+         *
+         * @see http_cursor_find
+         */
+        bool find (View field);
+    };
+
+    /*!
+     * @brief Range over the values of an HTTP header, in buffer order.
+     *
+     * Nothing is copied until you ask for it:
+     * @code
+     *  for (http::View value : head.find_all("Via")) {
+     *    // ...
+     *  }
+     *  std::string forwarded = head.find_all("X-Forwarded-For").join();
+     * @endcode
+     *
+     * @warning Ranges and their iterators are invalidated when the buffer is
+     *  modified or destroyed.
+     *
+     * @see Head::find_all
+     */
+    class Values
+    {
+        /* nested types. */
+    public:
+        /*!
+         * @brief Input iterator over the values.
+         */
+        class iterator
+        {
+            /* nested types. */
+        public:
+            typedef std::input_iterator_tag iterator_category;
+            typedef View value_type;
+            typedef std::ptrdiff_t difference_type;
+            typedef const View * pointer;
+            typedef View reference;
+
+            /* data. */
+        private:
+            ::http_cursor myCursor;
+            View myField;
+            bool myEnd;
+
+            /* construction. */
+        public:
+            /*!
+             * @brief Create an iterator past the last value.
+             */
+            iterator ();
+
+            /*!
+             * @brief Locate the first value of @a field in @a head.
+             */
+            iterator (const ::http_head& head, View field);
+
+            /* methods. */
+        public:
+            /*!
+             * @brief Access the current value.
+             */
+            View operator* () const;
+
+            /*!
+             * @brief Locate the next value.
+             */
+            iterator& operator++ ();
+
+            /*!
+             * @brief Locate the next value.
+             */
+            iterator operator++ (int);
+
+            /*!
+             * @brief Check if both iterators point to the same value.
+             */
+            bool operator== (const iterator& rhs) const;
+
+            /*!
+             * @brief Check if the iterators point to different values.
+             */
+            bool operator!= (const iterator& rhs) const;
+        };
+
+        /* data. */
+    private:
+        const ::http_head * myHead;
+        View myField;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Refer to all values of @a field in @a head.
+         */
+        Values (const Head& head, View field);
+
+        /*!
+         * @brief Refer to all values of @a field in @a snapshot.
+         */
+        Values (const Snapshot& snapshot, View field);
+
+#if defined(CHTTP_BASIC_HEAD)
+        /*!
+         * @brief Refer to all values of @a field in @a head.
+         */
+        template<std::size_t N>
+        Values (const BasicHead<N>& head, View field)
+            : myHead(&head.backend()), myField(field)
+        {
+        }
+#endif
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Locate the first value.
+         */
+        iterator begin () const;
+
+        /*!
+         * @brief Iterate up to the last value.
+         */
+        iterator end () const;
+
+        /*!
+         * @brief Check if there are no values.
+         */
+        bool empty () const;
+
+        /*!
+         * @brief Copy all values, separated by ", ".
+         *
+         * @see http_head_coalesce
+         */
+        std::string join () const;
+    };
+
+    /*!
+     * @brief Shared, immutable copy of HTTP headers.
+     *
+     * Copies refer to the same headers, and may be handed to other threads:
+     * @code
+     *  http::Snapshot snapshot = head.freeze();
+     *  std::thread worker([snapshot]{
+     *    route(snapshot.find("Host"));
+     *  });
+     * @endcode
+     *
+     * @see http_snapshot
+     */
+    class Snapshot
+    {
+        /* data. */
+    private:
+        ::http_snapshot * myBackend;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Make an immutable copy of @a head.
+         * @param head HTTP headers to copy.
+         * @exception std::bad_alloc Could not allocate the snapshot.
+         *
+         * @see http_head_freeze
+         */
+        explicit Snapshot (const Head& head);
+
+        /*!
+         * @brief Share the headers in @a other.
+         */
+        Snapshot (const Snapshot& other);
+
+        /*!
+         * @brief Release the headers, once the last copy goes away.
+         */
+        ~Snapshot ();
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Share the headers in @a other instead.
+         */
+        Snapshot& operator= (const Snapshot& other);
+
+        /*!
+         * @internal
+         * @brief Access the native representation.
+         * @return The read-only headers in the snapshot.
+         */
+        const ::http_head& backend () const;
+
+        /*!
+         * @brief Search for an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         */
+        View find (View field) const;
+
+        /*!
+         * @brief Search for an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         */
+        View find (const char * field) const;
+
+        /*!
+         * @brief Search for a well-known HTTP header.
+         * @param id Identifier of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         *
+         * @see http_head_find_id
+         */
+        View find (::http_header id) const;
+
+#if defined(CHTTP_CXX11)
+        /*!
+         * @brief Search for an HTTP header by a name hashed in advance.
+         * @param key The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         *
+         * @see http_head_find_hashed
+         */
+        View find (const Key& key) const
+        {
+            return (::http_head_find_hashed(&backend(),
+                key.data(), key.size(), key.hashed()));
+        }
+#endif
+
+        /*!
+         * @brief Refer to all values of an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return A range over the values, in order.
+         */
+        Values find_all (View field) const;
+    };
+
+#if defined(CHTTP_BASIC_HEAD)
+    /*!
+     * @internal
+     * @brief Allocator that never provides memory.
+     *
+     * Buffers that use it keep a fixed capacity, and run without an index
+     * or a cache of parsed values.
+     */
+    struct FixedAllocator
+    {
+        static void * acquire (void *, std::size_t)
+        {
+            return (0);
+        }
+
+        static void * resize (void *, void *, std::size_t, std::size_t)
+        {
+            return (0);
+        }
+
+        static void release (void *, void *, std::size_t)
+        {
+        }
+
+        static constexpr ::http_allocator backend = {
+            &acquire, &resize, &release, 0
+        };
+    };
+
+    /*!
+     * @brief Buffer for HTTP headers with a fixed capacity of @a N bytes.
+     *
+     * The memory is part of the object, so the buffer never touches the
+     * heap.  Headers known at compile time can be built into a constant:
+     * @code
+     *  static constexpr http::BasicHead<128> response{
+     *    {"Server", "chttp"},
+     *    {"Content-Type", "text/plain"},
+     *  };
+     *  http::Cursor cursor(response);
+     * @endcode
+     *
+     * @note Names in prebuilt headers are stored as given, even if they are
+     *  well-known.  Lookups still compare names without regard to case.
+     *
+     * @see SmallHead
+     */
+    template<std::size_t N>
+    class BasicHead
+    {
+        static_assert(N > 0, "HTTP headers need at least one byte.");
+
+        /* nested types. */
+    public:
+        /*!
+         * @brief Name and value of an HTTP header in a prebuilt buffer.
+         */
+        typedef std::pair<const char*, const char*> Header;
+
+        /* data. */
+    private:
+        std::array<char, N> myData;
+        ::http_head myBackend;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Create an empty buffer.
+         */
+        constexpr BasicHead ()
+            : myData{}, myBackend{}
+        {
+            attach();
+        }
+
+        /*!
+         * @brief Create a buffer holding @a headers, in order.
+         * @param headers Names and values of the HTTP headers.
+         * @exception std::bad_alloc The headers do not fit in @a N bytes, or
+         *  a name is empty or starts with a control character, as rejected
+         *  by @c http_head_push (either fails to compile in a constant
+         *  expression).
+         */
+        constexpr BasicHead (std::initializer_list<Header> headers)
+            : myData{}, myBackend{}
+        {
+            attach();
+            for (const Header& header : headers) {
+                if ((header.first == 0) || (header.second == 0)
+                    || (static_cast<unsigned char>(header.first[0]) < 0x20))
+                {
+                    throw (std::bad_alloc());
+                }
+                append(header.first);
+                append(header.second);
+            }
+        }
+
+        /*!
+         * @brief Copy the headers in @a other.
+         */
+        constexpr BasicHead (const BasicHead& other)
+            : myData(other.myData), myBackend(other.myBackend)
+        {
+            attach();
+        }
+
+        /* methods. */
+    private:
+        constexpr void attach ()
+        {
+            myBackend.data = myBackend.storage = myData.data();
+            myBackend.size = myBackend.limit = N;
+            myBackend.allocator = &FixedAllocator::backend;
+        }
+
+        constexpr void append (const char * text)
+        {
+            do {
+                if ((myBackend.used + 1) >= N) {
+                    throw (std::bad_alloc());
+                }
+                myData[myBackend.used++] = *text;
+            }
+            while (*text++ != '\0');
+        }
+
+    public:
+        /*!
+         * @brief Copy the headers in @a other instead.
+         */
+        constexpr BasicHead& operator= (const BasicHead& other)
+        {
+            myData = other.myData;
+            myBackend = other.myBackend;
+            attach();
+            return (*this);
+        }
+
+        /*!
+         * @internal
+         * @brief Access the native representation.
+         * @return The native representation.
+         */
+        ::http_head& backend ()
+        {
+            return (myBackend);
+        }
+
+        /*!
+         * @internal
+         * @brief Access the native representation.
+         * @return The native representation.
+         */
+        const ::http_head& backend () const
+        {
+            return (myBackend);
+        }
+
+        /*!
+         * @brief Empty the buffer.
+         */
+        void reset ()
+        {
+            ::http_head_reset(&myBackend);
+        }
+
+        /*!
+         * @brief Append an HTTP header.
+         * @param field The name of the HTTP header.
+         * @param value The data of the HTTP header.
+         * @return @c false if the header does not fit, else @c true.
+         */
+        bool push (View field, View value)
+        {
+            ::http_mark mark;
+            if (::http_head_mark(&myBackend, &mark) == 0) {
+                return (false);
+            }
+            if ((::http_head_push_field(&mark,
+                                        field.data(), field.size()) == 0)
+              ||(::http_head_push_value(&mark,
+                                        value.data(), value.size()) == 0)
+              ||(::http_head_commit(&mark) == 0))
+            {
+                ::http_head_cancel(&mark);
+                return (false);
+            }
+            return (true);
+        }
+
+        /*!
+         * @brief Search for an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         */
+        View find (View field) const
+        {
+            return (::http_head_findn(&myBackend,
+                                      field.data(), field.size()));
+        }
+
+        /*!
+         * @brief Search for an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         */
+        View find (const char * field) const
+        {
+            return (::http_head_find(&myBackend, field));
+        }
+
+        /*!
+         * @brief Search for a well-known HTTP header.
+         * @param id Identifier of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         *
+         * @see http_head_find_id
+         */
+        View find (::http_header id) const
+        {
+            return (::http_head_find_id(&myBackend, id));
+        }
+
+        /*!
+         * @brief Search for an HTTP header by a name hashed in advance.
+         * @param key The name of the HTTP header to look for.
+         * @return The value of the first such header, or an empty view.
+         *
+         * @see http_head_find_hashed
+         */
+        View find (const Key& key) const
+        {
+            return (::http_head_find_hashed(&myBackend,
+                key.data(), key.size(), key.hashed()));
+        }
+
+        /*!
+         * @brief Refer to all values of an HTTP header.
+         * @param field The name of the HTTP header to look for.
+         * @return A range over the values, in order.
+         */
+        Values find_all (View field) const
+        {
+            return (Values(*this, field));
+        }
+    };
+#endif
+
+    /*!
+     * @brief Incremental parser for HTTP/1.x headers.
+     *
+     * @see http_parser
+     */
+    class Parser
+    {
+        /* data. */
+    private:
+        ::http_parser myBackend;
+
+        /* construction. */
+    public:
+        /*!
+         * @brief Prepare to parse headers into @a head.
+         * @param head Buffer that receives the headers.
+         */
+        explicit Parser (Head& head);
+
+#if defined(CHTTP_BASIC_HEAD)
+        /*!
+         * @brief Prepare to parse headers into @a head.
+         * @param head Buffer that receives the headers.
+         */
+        template<std::size_t N>
+        explicit Parser (BasicHead<N>& head)
+        {
+            ::http_parser_init(&myBackend, &head.backend());
+        }
+#endif
+
+        /* methods. */
+    public:
+        /*!
+         * @brief Parse a chunk of data.
+         * @param data Data received from the peer.
+         * @param size Number of valid bytes starting at @a data.
+         * @return The number of bytes consumed.
+         *
+         * @see http_parser_feed
+         */
+        std::size_t feed (const char * data, std::size_t size);
+
+        /*!
+         * @brief Check if the blank line ending the headers has been parsed.
+         */
+        bool done () const;
+
+        /*!
+         * @brief Check if the data was rejected.
+         */
+        bool fail () const;
     };
 
 }
@@ -0,0 +1,186 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+/*!
+ * @file
+ * @brief Test bulk copies of HTTP headers.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    // Drops the headers with one name.
+    struct Drop
+    {
+        const char * name;
+
+        int operator() (http::View field, http::View value) const
+        {
+            return ((field == name)? 0 : 1);
+        }
+    };
+
+    // Names seen by the filter, in order.
+    std::string seen;
+
+    int stop_at_cookie (void * context, const char * field, std::size_t size,
+                        const char * value, std::size_t value_size)
+    {
+        seen.append(field, size).append(";");
+        if ((size == 6) && (std::strncmp(field, "Cookie", 6) == 0)) {
+            return (-1);
+        }
+        return ((size != 10) || (std::strncmp(field, "Connection", 10) != 0));
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    ::http_head source;
+    ::http_head_init(&source, 256);
+    ::http_head_configure(&source, HTTP_HEAD_TOKENS);
+    ::http_head_push(&source, "Host", "example.com");
+    ::http_head_push(&source, "Connection", "keep-alive");
+    ::http_head_push(&source, "X-Trace", "abc");
+    ::http_head_push(&source, "Cookie", "a=b");
+    ::http_head_push(&source, "Accept", "*/*");
+    ::http_head_index(&source);
+
+    // Clones are exact copies, index included.
+    ::http_head clone;
+    if (!::http_head_clone(&clone, &source, 0) ||
+        (clone.used != source.used) || (clone.size != source.size) ||
+        (std::memcmp(clone.data, source.data, source.used+1) != 0) ||
+        (clone.index == 0) || (clone.options != source.options) ||
+        (std::strcmp(::http_head_find(&clone, "x-trace"), "abc") != 0)) {
+        return (fail("Could not clone headers."));
+    }
+
+    // Appending everything splices the buffer as is.
+    ::http_head upstream;
+    ::http_head_init(&upstream, 256);
+    ::http_head_push(&upstream, "Via", "1.1 proxy");
+    ::http_head_index(&upstream);
+    if (!::http_head_append_all(&upstream, &source) ||
+        (std::memcmp(upstream.data+upstream.used-source.used,
+                     source.data, source.used+1) != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "Via"), "1.1 proxy") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "Accept"), "*/*") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "X-Trace"), "abc") != 0)) {
+        return (fail("Could not append all headers."));
+    }
+    ::http_head_kill(&upstream);
+
+    // Removed headers are skipped.
+    ::http_head_remove(&clone, "Host", 4);
+    ::http_head_init(&upstream, 256);
+    if ((clone.dead == 0) || !::http_head_append_all(&upstream, &clone) ||
+        (upstream.dead != 0) ||
+        (upstream.used != clone.used-clone.dead) ||
+        (std::strcmp(::http_head_find(&upstream, "Host"), "") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "Cookie"), "a=b") != 0)) {
+        return (fail("Could not append live headers."));
+    }
+    ::http_head_kill(&upstream);
+    ::http_head_kill(&clone);
+
+    // Filters drop headers and stop early.
+    ::http_head_init(&upstream, 256);
+    if (!::http_head_append_if(&upstream, &source, stop_at_cookie, 0) ||
+        (seen != "Host;Connection;X-Trace;Cookie;") ||
+        (std::strcmp(::http_head_find(&upstream, "Connection"), "") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "X-Trace"), "abc") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "Cookie"), "") != 0)) {
+        return (fail("Could not filter headers."));
+    }
+    ::http_head_kill(&upstream);
+
+    // Deny-lists leave out hop-by-hop headers.
+    const char * hops[] = { "connection", "keep-alive", "te" };
+    ::http_head_init(&upstream, 256);
+    ::http_head_configure(&upstream, HTTP_HEAD_LOWERCASE);
+    if (!::http_head_append_except(&upstream, &source, hops, 3) ||
+        (std::strcmp(::http_head_find(&upstream, "Connection"), "") != 0) ||
+        (std::strcmp(::http_head_find(&upstream, "X-TRACE"), "abc") != 0) ||
+        (std::strstr(upstream.data, "X-Trace") != 0)) {
+        return (fail("Could not leave out headers."));
+    }
+    ::http_head_kill(&upstream);
+
+    // Nothing is appended when the headers do not fit.
+    ::http_head_init(&upstream, 16);
+    ::http_head_push(&upstream, "A", "b");
+    if (::http_head_append_all(&upstream, &source) ||
+        ::http_head_append_except(&upstream, &source, hops, 3) ||
+        (upstream.used != 4)) {
+        return (fail("Appended headers overflowed."));
+    }
+    ::http_head_kill(&upstream);
+    ::http_head_kill(&source);
+
+    // The C++ wrapper takes function objects.
+    http::Head request(256);
+    request.push("Host", "example.com");
+    request.push("Proxy-Connection", "close");
+    request.push("Accept", "*/*");
+    http::Head forward(256);
+    const char * drop[] = { "Host" };
+    Drop hop = { "Proxy-Connection" };
+    http::Head other(256);
+    if (!forward.append(request) ||
+        !other.append_if(request, hop) ||
+        !forward.append_except(request, drop) ||
+        !other.find("Proxy-Connection").empty() ||
+        (other.find("Accept") != "*/*") ||
+        (forward.find_all("Accept").join() != "*/*, */*") ||
+        (forward.find_all("Host").join() != "example.com")) {
+        return (fail("Could not copy headers in C++."));
+    }
+
+#if defined(CHTTP_CXX11)
+    // Clones and lambdas work too.
+    http::Head copy = request.clone();
+    if (!copy.append_if(request, [](http::View field, http::View) {
+            return ((field == "Accept")? 1 : 0);
+        }) ||
+        (copy.find_all("Accept").join() != "*/*, */*") ||
+        (copy.find_all("Host").join() != "example.com")) {
+        return (fail("Could not copy headers with a lambda."));
+    }
+#endif
+
+    return (EXIT_SUCCESS);
+}
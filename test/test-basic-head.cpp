@@ -0,0 +1,121 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+/*!
+ * @file
+ * @brief Test buffers with a fixed, inline capacity.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <new>
+#include <string>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    // Built at compile time.
+    constexpr http::BasicHead<128> response{
+        {"Server", "chttp"},
+        {"Content-Type", "text/plain"},
+        {"Vary", "Accept"},
+    };
+
+}
+
+int main (int argc, char ** argv)
+{
+    // Prebuilt headers share the lookup machinery.
+    if ((response.find("content-type") != "text/plain") ||
+        (response.find(HTTP_HEADER_SERVER) != "chttp") ||
+        (response.find(http::hdr::vary) != "Accept") ||
+        !response.find("Host").empty()) {
+        return (fail("Could not find prebuilt headers."));
+    }
+    std::string names;
+    http::Cursor cursor(response);
+    while (cursor.next()) {
+        names += cursor.field() + ';';
+    }
+    if (names != "Server;Content-Type;Vary;") {
+        return (fail("Could not iterate prebuilt headers."));
+    }
+
+    // Copies refer to their own memory.
+    http::BasicHead<128> head = response;
+    if ((head.backend().data == response.backend().data) ||
+        !head.push("Vary", "Accept-Encoding") ||
+        (head.find_all("Vary").join() != "Accept, Accept-Encoding") ||
+        (response.find_all("Vary").join() != "Accept")) {
+        return (fail("Could not extend a copy."));
+    }
+
+    // The capacity is fixed.
+    if (head.push("X-Padding", std::string(128, 'x')) ||
+        (head.backend().size != 128) ||
+        (head.backend().data < reinterpret_cast<char*>(&head)) ||
+        (head.backend().data >= reinterpret_cast<char*>(&head + 1))) {
+        return (fail("Fixed buffer grew."));
+    }
+    if (::http_head_index(&head.backend()) != 0) {
+        return (fail("Fixed buffer allocated an index."));
+    }
+    try {
+        http::BasicHead<16> small{{"Content-Type", "text/plain"}};
+        return (fail("Prebuilt headers overflowed."));
+    }
+    catch (const std::bad_alloc&) {
+    }
+    try {
+        http::BasicHead<16> bad{{"\001X", "y"}};
+        return (fail("Prebuilt headers took a control character."));
+    }
+    catch (const std::bad_alloc&) {
+    }
+
+    // Parse straight into the buffer.
+    http::BasicHead<128> request;
+    http::Parser parser(request);
+    const std::string data =
+        "Host: example.com\r\n"
+        "Content-Length: 42\r\n"
+        "\r\n";
+    parser.feed(data.data(), data.size());
+    if (!parser.done() || parser.fail() ||
+        (request.find("Content-Length") != "42")) {
+        return (fail("Could not parse into a fixed buffer."));
+    }
+    request.reset();
+    if (!request.find("Host").empty()) {
+        return (fail("Could not reset a fixed buffer."));
+    }
+
+    return (EXIT_SUCCESS);
+}
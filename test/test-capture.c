@@ -0,0 +1,166 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test capturing headers to a file and replaying them.
+ */
+
+#include <chttp.h>
+#include <chttp-capture.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char path[] = "test-capture.cap";
+
+static int check (const http_head * head, const char * expected)
+{
+    char text[256];
+    size_t used = 0;
+    http_cursor cursor;
+    http_cursor_init(&cursor, head);
+    while (http_cursor_next(&cursor)) {
+        used += (size_t)sprintf(text+used, "%s: %s\n",
+                                cursor.field, cursor.value);
+    }
+    text[used] = '\0';
+    return (strcmp(text, expected) == 0);
+}
+
+static int capture (const http_head * head)
+{
+    http_capture writer;
+    if (!http_capture_open(&writer, path)) {
+        return 0;
+    }
+    if (!http_capture_push(&writer, head)) {
+        http_capture_close(&writer);
+        return 0;
+    }
+    return (http_capture_close(&writer));
+}
+
+int main(int argc, char ** argv)
+{
+    static const char * expected[] = {
+        "Host: example.com\nContent-Length: 42\nX-Empty: \n",
+        "",
+        "x-second: 2\n",
+    };
+    http_head head;
+    http_replay replay;
+    FILE * file = 0;
+    int count = 0;
+    int pass = 0;
+
+    remove(path);
+    // Tokens are written out as names, removed headers are left out.
+    http_head_init(&head, 256);
+    http_head_configure(&head, HTTP_HEAD_TOKENS);
+    http_head_push(&head, "Host", "example.com");
+    http_head_push(&head, "X-Removed", "1");
+    http_head_push(&head, "content-length", "42");
+    http_head_push(&head, "X-Empty", "");
+    http_head_remove(&head, "x-removed", 9);
+    if (!capture(&head)) {
+        fprintf(stderr, "Could not capture headers.\n");
+        return (EXIT_FAILURE);
+    }
+    // Reopening appends.
+    http_head_reset(&head);
+    if (!capture(&head)) {
+        fprintf(stderr, "Could not capture empty headers.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_push(&head, "x-second", "2");
+    if (!capture(&head)) {
+        fprintf(stderr, "Could not capture more headers.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_kill(&head);
+
+    if (!http_replay_open(&replay, path)) {
+        fprintf(stderr, "Could not open capture.\n");
+        return (EXIT_FAILURE);
+    }
+    for (pass = 0; pass < 2; ++pass)
+    {
+        for (count = 0; http_replay_next(&replay); ++count)
+        {
+            if ((count >= 3) ||
+                !check(http_replay_head(&replay), expected[count])) {
+                fprintf(stderr, "Record #%d doesn't match.\n", count);
+                return (EXIT_FAILURE);
+            }
+        }
+        if ((count != 3) || http_replay_fail(&replay)) {
+            fprintf(stderr, "Replay failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_replay_rewind(&replay);
+    }
+    if (strcmp(http_head_find(http_replay_head(&replay), "Host"), "") != 0) {
+        fprintf(stderr, "Rewind didn't clear the record.\n");
+        return (EXIT_FAILURE);
+    }
+    http_replay_close(&replay);
+
+    // Damaged records stop replay: here, a value without a terminator.
+    file = fopen(path, "ab");
+    fwrite("\004\000\000\000X\000a\000", 8, 1, file);
+    fclose(file);
+    if (!http_replay_open(&replay, path)) {
+        fprintf(stderr, "Could not reopen capture.\n");
+        return (EXIT_FAILURE);
+    }
+    for (count = 0; http_replay_next(&replay); ++count) {
+    }
+    if ((count != 3) || !http_replay_fail(&replay)) {
+        fprintf(stderr, "Damaged record was accepted.\n");
+        return (EXIT_FAILURE);
+    }
+    http_replay_close(&replay);
+
+    // Other files are rejected.
+    file = fopen(path, "wb");
+    fwrite("GET / HTTP/1.1\r\n", 16, 1, file);
+    fclose(file);
+    if (http_replay_open(&replay, path)) {
+        fprintf(stderr, "Opened a file that is not a capture.\n");
+        return (EXIT_FAILURE);
+    }
+    {
+        http_capture writer;
+        if (http_capture_open(&writer, path)) {
+            fprintf(stderr, "Appended to a file that is not a capture.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    remove(path);
+
+    return (EXIT_SUCCESS);
+}
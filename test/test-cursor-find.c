@@ -0,0 +1,123 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test lookup of repeated headers, with and without an index.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char * headers[] = {
+    "Via", "1.1 proxy-a",
+    "Host", "example.com",
+    "Set-Cookie", "a=1; Expires=Wed, 21 Oct 2015 07:28:00 GMT",
+    "via", "",
+    "Accept", "text/html",
+    "VIA", "1.1 proxy-c",
+    "Set-Cookie", "b=2",
+};
+
+static int check (http_head * head)
+{
+    http_cursor cursor;
+    char data[64];
+    size_t size = 0;
+    const char * expected = "1.1 proxy-a, , 1.1 proxy-c";
+
+    // Visit values in buffer order, including the empty one.
+    http_cursor_init(&cursor, head);
+    if (!http_cursor_find(&cursor, "via", 3) ||
+        (strcmp(cursor.value, "1.1 proxy-a") != 0) ||
+        !http_cursor_find(&cursor, "via", 3) || (cursor.value_size != 0) ||
+        !http_cursor_find(&cursor, "via", 3) ||
+        (strcmp(cursor.value, "1.1 proxy-c") != 0) ||
+        http_cursor_find(&cursor, "via", 3)) {
+        return 0;
+    }
+
+    // Mix with plain iteration.
+    http_cursor_init(&cursor, head);
+    if (!http_cursor_find(&cursor, "Set-Cookie", 10) ||
+        !http_cursor_next(&cursor) || (cursor.field_size != 3) ||
+        !http_cursor_find(&cursor, "Set-Cookie", 10) ||
+        (strcmp(cursor.value, "b=2") != 0) ||
+        http_cursor_find(&cursor, "Missing", 7)) {
+        return 0;
+    }
+
+    // Join values, asking for the size first.
+    size = http_head_coalesce(head, "Via", 3, 0, 0);
+    if ((size != strlen(expected)) ||
+        (http_head_coalesce(head, "Via", 3, data, size+1) != size) ||
+        (strcmp(data, expected) != 0)) {
+        return 0;
+    }
+    // Truncate to the buffer size.
+    if ((http_head_coalesce(head, "Via", 3, data, 14) != size) ||
+        (strcmp(data, "1.1 proxy-a, ") != 0)) {
+        return 0;
+    }
+    if ((http_head_coalesce(head, "Host", 4, data, sizeof(data)) != 11) ||
+        (strcmp(data, "example.com") != 0) ||
+        (http_head_coalesce(head, "Missing", 7, data, sizeof(data)) != 0) ||
+        (strcmp(data, "") != 0)) {
+        return 0;
+    }
+    return 1;
+}
+
+int main(int argc, char ** argv)
+{
+    http_head head;
+    size_t i = 0;
+    int pass = 0;
+
+    for (pass = 0; pass < 3; ++pass)
+    {
+        http_head_init(&head, 1024);
+        // Try with tokens and index too.
+        if (pass > 0) {
+            http_head_configure(&head, HTTP_HEAD_TOKENS);
+        }
+        if (pass > 1) {
+            http_head_index(&head);
+        }
+        for (i = 0; i < sizeof(headers)/sizeof(headers[0]); i += 2) {
+            http_head_push(&head, headers[i], headers[i+1]);
+        }
+        if (!check(&head)) {
+            fprintf(stderr, "Lookup failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_kill(&head);
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,95 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that iteration reports the right header names and sizes.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char ** argv)
+{
+    char field[128];
+    char value[128];
+    http_cursor cursor;
+    size_t i;
+
+    http_head head;
+    http_head_init(&head, 32*1024);
+
+    // Iterating over an empty buffer yields nothing.
+    http_cursor_init(&cursor, &head);
+    if (http_cursor_next(&cursor))
+    {
+        fprintf(stderr, "Empty buffer has headers.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Use lengths that straddle the 16 and 32 byte vector widths.
+    for (i = 1; i < 100; ++i)
+    {
+        memset(field, 'F', i), field[i] = '\0';
+        memset(value, 'v', i-1), value[i-1] = '\0';
+        if (!http_head_push(&head, field, value))
+        {
+            fprintf(stderr, "Could not push header.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+
+    // Verify that each header is reported with the right size.
+    http_cursor_init(&cursor, &head);
+    for (i = 1; i < 100; ++i)
+    {
+        if (!http_cursor_next(&cursor))
+        {
+            fprintf(stderr, "Missing header.\n");
+            return (EXIT_FAILURE);
+        }
+        if ((cursor.field_size != i) || (strlen(cursor.field) != i))
+        {
+            fprintf(stderr, "Wrong field size.\n");
+            return (EXIT_FAILURE);
+        }
+        if ((cursor.value_size != i-1) || (strlen(cursor.value) != i-1))
+        {
+            fprintf(stderr, "Wrong value size.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if (http_cursor_next(&cursor))
+    {
+        fprintf(stderr, "Extra header.\n");
+        return (EXIT_FAILURE);
+    }
+
+    http_head_kill(&head);
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,68 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test the C++ wrappers for looking up several headers at once.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+    const char * fields[] = { "Host", "Content-Type", "X-Missing" };
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    http::Head head(4*1024);
+    head.push("Content-Type", "text/plain");
+    head.push("Host", "example.com");
+
+    http::View values[3];
+    if ((head.find(fields, values) != 2) || (values[0] != "example.com") ||
+        (values[1] != "text/plain") || !values[2].empty()) {
+        return (fail("Find many failed."));
+    }
+
+    const http::Lookup<3> lookup(fields);
+    http::View others[3];
+    if ((head.find(lookup, others) != 2) || (others[0] != "example.com") ||
+        (others[1] != "text/plain") || !others[2].empty()) {
+        return (fail("Lookup failed."));
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,153 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that buffers grow through a custom allocator.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+typedef struct counters
+{
+    size_t blocks;
+    size_t resizes;
+} counters;
+
+static void * acquire (void * context, size_t size)
+{
+    ++((counters*)context)->blocks;
+    return (malloc(size));
+}
+
+static void * resize (void * context, void * data, size_t used, size_t size)
+{
+    ++((counters*)context)->resizes;
+    return (realloc(data, size));
+}
+
+static void release (void * context, void * data, size_t size)
+{
+    --((counters*)context)->blocks;
+    free(data);
+}
+
+int main(int argc, char ** argv)
+{
+    char field[32];
+    char value[32];
+    counters stats = { 0, 0 };
+    http_allocator allocator = { acquire, resize, release, 0 };
+    http_mark mark;
+    int i;
+
+    http_head head;
+    allocator.context = &stats;
+    if (!http_head_init_ex(&head, 16, 4*1024, &allocator))
+    {
+        fprintf(stderr, "Could not allocate.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_index(&head);
+
+    // Push far more than the initial capacity.
+    for (i = 0; i < 100; ++i)
+    {
+        sprintf(field, "X-Header-%d", i);
+        sprintf(value, "%d", i);
+        if (!http_head_push(&head, field, value))
+        {
+            fprintf(stderr, "Could not push header.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if ((stats.resizes == 0) || (head.size > head.limit))
+    {
+        fprintf(stderr, "Buffer did not grow as expected.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Grow in the middle of a partial push.
+    http_head_mark(&head, &mark);
+    for (i = 0; i < 50; ++i)
+    {
+        if (!http_head_push_field(&mark, "X-Long-Name-", 12))
+        {
+            fprintf(stderr, "Could not push field.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if (!http_head_push_value(&mark, "long", 4) || !http_head_commit(&mark))
+    {
+        fprintf(stderr, "Could not push value.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Exceeding the limit fails and leaves the buffer intact.
+    http_head_mark(&head, &mark);
+    for (i = 0; i < 4*1024; ++i)
+    {
+        if (!http_head_push_field(&mark, "X", 1)) {
+            break;
+        }
+    }
+    if (i == 4*1024)
+    {
+        fprintf(stderr, "Buffer grew past the limit.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_cancel(&mark);
+
+    // Verify the contents.
+    for (i = 0; i < 100; ++i)
+    {
+        sprintf(field, "X-Header-%d", i);
+        sprintf(value, "%d", i);
+        if (strcmp(http_head_find(&head, field), value) != 0)
+        {
+            fprintf(stderr, "Header doesn't match.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if (strlen(http_head_find(&head, "X")) != 0)
+    {
+        fprintf(stderr, "Cancelled header found.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Verify that all memory was returned.
+    http_head_kill(&head);
+    if (stats.blocks != 0)
+    {
+        fprintf(stderr, "Memory leak.\n");
+        return (EXIT_FAILURE);
+    }
+
+    return (EXIT_SUCCESS);
+}
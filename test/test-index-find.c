@@ -0,0 +1,124 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that indexed lookups match linear lookups.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char ** argv)
+{
+    char field[32];
+    char value[32];
+    const char * match = 0;
+    http_mark mark;
+    int i;
+
+    http_head head;
+    http_head_init(&head, 16*1024);
+
+    // Index a buffer that already holds a few headers.
+    for (i = 0; i < 5; ++i)
+    {
+        sprintf(field, "X-Header-%d", i);
+        sprintf(value, "%d", i);
+        http_head_push(&head, field, value);
+    }
+    if (!http_head_index(&head))
+    {
+        fprintf(stderr, "Could not index.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Keep pushing, forcing the index to grow a few times.
+    for (i = 5; i < 80; ++i)
+    {
+        sprintf(field, "X-Header-%d", i);
+        sprintf(value, "%d", i);
+        if (!http_head_push(&head, field, value))
+        {
+            fprintf(stderr, "Could not push header.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    http_head_push(&head, "x-header-7", "duplicate");
+
+    // Verify that all headers are found, regardless of case.
+    for (i = 0; i < 80; ++i)
+    {
+        sprintf(field, "x-HEADER-%d", i);
+        sprintf(value, "%d", i);
+        match = http_head_find(&head, field);
+        if (strcmp(match, value) != 0)
+        {
+            fprintf(stderr, "Header '%s' doesn't match.\n", field);
+            return (EXIT_FAILURE);
+        }
+    }
+
+    // Verify that missing headers are not found.
+    if (strlen(http_head_find(&head, "X-Header-80")) != 0)
+    {
+        fprintf(stderr, "Missing header found.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Roll back some committed headers and check they're gone.
+    if (!http_head_mark(&head, &mark))
+    {
+        fprintf(stderr, "Could not start operation.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_push(&head, "Content-Type", "text/plain");
+    if (strcmp(http_head_find(&head, "Content-Type"), "text/plain") != 0)
+    {
+        fprintf(stderr, "Header not found.\n");
+        return (EXIT_FAILURE);
+    }
+    if (!http_head_cancel(&mark))
+    {
+        fprintf(stderr, "Could not cancel.\n");
+        return (EXIT_FAILURE);
+    }
+    if (strlen(http_head_find(&head, "Content-Type")) != 0)
+    {
+        fprintf(stderr, "Cancelled header found.\n");
+        return (EXIT_FAILURE);
+    }
+    if (strcmp(http_head_find(&head, "X-Header-79"), "79") != 0)
+    {
+        fprintf(stderr, "Header lost by cancel.\n");
+        return (EXIT_FAILURE);
+    }
+
+    http_head_kill(&head);
+    return (EXIT_SUCCESS);
+}
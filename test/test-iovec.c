@@ -0,0 +1,93 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that headers are serialized to an I/O vector.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+#if !defined(_WIN32)
+#   include <sys/uio.h>
+#endif
+
+int main(int argc, char ** argv)
+{
+#if !defined(_WIN32)
+    const char expected[] =
+        "Host: example.com\r\n"
+        "Content-Length: 0\r\n"
+        "X-Empty: \r\n";
+    char wire[sizeof(expected)];
+    struct iovec iov[12];
+    size_t used = 0;
+    size_t size = 0;
+    size_t i;
+
+    http_head head;
+    http_head_init(&head, 4*1024);
+    http_head_push(&head, "Host", "example.com");
+    http_head_push(&head, "Content-Length", "0");
+    http_head_push(&head, "X-Empty", "");
+
+    // Check the size query.
+    if (http_head_iovec_size(&head) != 12)
+    {
+        fprintf(stderr, "Wrong I/O vector size.\n");
+        return (EXIT_FAILURE);
+    }
+    if (http_head_to_iovec(&head, iov, 11) != 0)
+    {
+        fprintf(stderr, "I/O vector overflow not detected.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Gather the I/O vector and compare with the wire format.
+    size = http_head_to_iovec(&head, iov, 12);
+    for (i = 0; i < size; ++i)
+    {
+        if (used+iov[i].iov_len >= sizeof(wire))
+        {
+            fprintf(stderr, "Serialized headers too long.\n");
+            return (EXIT_FAILURE);
+        }
+        memcpy(wire+used, iov[i].iov_base, iov[i].iov_len);
+        used += iov[i].iov_len;
+    }
+    wire[used] = '\0';
+    if ((size != 12) || (strcmp(wire, expected) != 0))
+    {
+        fprintf(stderr, "Serialized headers don't match.\n");
+        return (EXIT_FAILURE);
+    }
+
+    http_head_kill(&head);
+#endif
+    return (EXIT_SUCCESS);
+}
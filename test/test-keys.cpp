@@ -0,0 +1,108 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+/*!
+ * @file
+ * @brief Test lookups by names hashed at compile time.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <iostream>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    // Lookups in every mode must agree.
+    int check (const http::Head& head)
+    {
+        using namespace http::literals;
+        if ((head.find(http::hdr::content_type) != "text/plain") ||
+            (head.find("CONTENT-LENGTH"_h) != "42") ||
+            (head.find("x-trace"_h) != "abc") ||
+            (head.find(http::Key("X-Trace-Id")) != "") ||
+            (head.find("x-tra"_h) != "") ||
+            (head.find(http::hdr::host) != "")) {
+            return (fail("Keyed lookup failed."));
+        }
+        return (0);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    using namespace http::literals;
+
+    // Keys are hashed at compile time, the same way as at run time.
+    static_assert(http::hdr::content_type.size() == 12,
+                  "Key size is wrong.");
+    static_assert("content-type"_h.hashed() ==
+                  http::hdr::content_type.hashed(),
+                  "Key hash depends on case.");
+    if ((http::hdr::content_type.hashed() !=
+         ::http_header_hash("Content-Type", 12)) ||
+        ("X-Trace"_h.hashed() != ::http_header_hash("x-trace", 7))) {
+        return (fail("Key hash differs from the library."));
+    }
+
+    http::Head head(1024);
+    head.push("Content-Type", "text/plain");
+    head.push("X-Trace", "abc");
+    head.push("Content-Length", "42");
+    if (check(head) != 0) {
+        return (EXIT_FAILURE);
+    }
+    head.index();
+    if (check(head) != 0) {
+        return (EXIT_FAILURE);
+    }
+
+    // Tokenized names hash like their canonical spelling.
+    http::Head tokens(1024);
+    tokens.configure(HTTP_HEAD_TOKENS);
+    tokens.push("content-type", "text/plain");
+    tokens.push("x-trace", "abc");
+    tokens.push("content-length", "42");
+    if (check(tokens) != 0) {
+        return (EXIT_FAILURE);
+    }
+    tokens.index();
+    if (check(tokens) != 0) {
+        return (EXIT_FAILURE);
+    }
+
+    // Snapshots accept keys too.
+    http::Snapshot snapshot = tokens.freeze();
+    if (snapshot.find("Content-Length"_h) != "42") {
+        return (fail("Keyed lookup in a snapshot failed."));
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,105 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test looking up several headers at once.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char * fields[] = {
+    "host", "X-Missing", "Content-Length", "x-empty", "Via", "HOST",
+    "Accept", "Cookie", "X-Request-ID", "X-Missing-Too",
+};
+
+static const char * expected[] = {
+    "example.com", "", "42", "", "a", "example.com",
+    "*/*", "a=1", "abc", "",
+};
+
+#define COUNT (sizeof(fields)/sizeof(fields[0]))
+
+static int check (const char ** values, size_t found)
+{
+    size_t i = 0;
+    if (found != COUNT-2) {
+        return 0;
+    }
+    for (i = 0; i < COUNT; ++i) {
+        if (strcmp(values[i], expected[i]) != 0) {
+            return 0;
+        }
+    }
+    return 1;
+}
+
+int main(int argc, char ** argv)
+{
+    http_head head;
+    http_lookup lookup;
+    const char * values[COUNT];
+    int pass = 0;
+
+    if (!http_lookup_init(&lookup, fields, COUNT)) {
+        fprintf(stderr, "Could not create lookup set.\n");
+        return (EXIT_FAILURE);
+    }
+    for (pass = 0; pass < 3; ++pass)
+    {
+        http_head_init(&head, 1024);
+        // Try with tokens and index too.
+        if (pass > 0) {
+            http_head_configure(&head, HTTP_HEAD_TOKENS);
+        }
+        if (pass > 1) {
+            http_head_index(&head);
+        }
+        http_head_push(&head, "Host", "example.com");
+        http_head_push(&head, "Via", "a");
+        http_head_push(&head, "Content-Length", "42");
+        http_head_push(&head, "X-Empty", "");
+        http_head_push(&head, "Via", "b");
+        http_head_push(&head, "Accept", "*/*");
+        http_head_push(&head, "Cookie", "a=1");
+        http_head_push(&head, "X-Request-ID", "abc");
+        if (!check(values, http_head_find_many(&head, fields, COUNT, values))) {
+            fprintf(stderr, "Find many failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        if (!check(values, http_head_lookup(&head, &lookup, values))) {
+            fprintf(stderr, "Lookup failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_kill(&head);
+    }
+    http_lookup_kill(&lookup);
+
+    return (EXIT_SUCCESS);
+}
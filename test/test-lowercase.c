@@ -0,0 +1,147 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test storing header names in lowercase.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Long enough to use the vector compare, with a partial last block.
+static const char long_name[] = "X-Some-Rather-Long-Header-Name-Here";
+
+static int check_names (const http_head * head, const char ** names)
+{
+    http_cursor cursor;
+    http_cursor_init(&cursor, head);
+    for (; http_cursor_next(&cursor); ++names)
+    {
+        if ((*names == 0) || (strcmp(cursor.field, *names) != 0) ||
+            (cursor.field_size != strlen(*names))) {
+            return 0;
+        }
+    }
+    return (*names == 0);
+}
+
+static int check_finds (const http_head * head)
+{
+    return ((strcmp(http_head_find(head, "HOST"), "example.com") == 0) &&
+            (strcmp(http_head_find(head, "content-TYPE"),
+                    "text/plain") == 0) &&
+            (strcmp(http_head_find(head,
+                "x-some-rather-long-header-name-HERE"), "1") == 0) &&
+            (strcmp(http_head_find(head,
+                "x-some-rather-long-header-name-herE"), "1") == 0) &&
+            (strcmp(http_head_find(head,
+                "x-some-rather-long-header-name-hera"), "") == 0) &&
+            (strcmp(http_head_find(head, "X-\xC3\x89t\xC3\xA9"), "2") == 0) &&
+            (strcmp(http_head_find(head, "X-\xC3\xA9t\xC3\xA9"), "") == 0) &&
+            (strcmp(http_head_find(head, "X-Missing"), "") == 0) &&
+            (strcmp(http_head_find_id(head, HTTP_HEADER_CONTENT_TYPE),
+                    "text/plain") == 0));
+}
+
+static void fill (http_head * head)
+{
+    http_head_push(head, "Host", "example.com");
+    http_head_push(head, "Content-Type", "text/plain");
+    http_head_push(head, long_name, "1");
+    // Non-ASCII bytes are never folded.
+    http_head_push(head, "X-\xC3\x89t\xC3\xA9", "2");
+}
+
+int main(int argc, char ** argv)
+{
+    static const char * lower[] = {
+        "host", "content-type", "x-some-rather-long-header-name-here",
+        "x-\xC3\x89t\xC3\xA9", 0,
+    };
+    static const char * mixed[] = {
+        "Host", "Content-Type", long_name, "X-\xC3\x89t\xC3\xA9", 0,
+    };
+    http_head head;
+    unsigned int options = 0;
+    int pass = 0;
+
+    for (pass = 0; pass < 4; ++pass)
+    {
+        // Try with tokens and index too.
+        options = HTTP_HEAD_LOWERCASE | ((pass & 1)? HTTP_HEAD_TOKENS : 0);
+        http_head_init(&head, 1024);
+        http_head_configure(&head, options);
+        if (pass > 1) {
+            http_head_index(&head);
+        }
+        fill(&head);
+        if (!check_names(&head, lower) || !check_finds(&head)) {
+            fprintf(stderr, "Lowercase names failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_kill(&head);
+    }
+
+    // Enabling the option folds names already in the buffer.
+    http_head_init(&head, 1024);
+    fill(&head);
+    if (!check_names(&head, mixed) || !check_finds(&head)) {
+        fprintf(stderr, "Mixed case names failed.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_configure(&head, HTTP_HEAD_LOWERCASE);
+    if (!check_names(&head, lower) || !check_finds(&head)) {
+        fprintf(stderr, "Folding names failed.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_kill(&head);
+
+    // Partial pushes are folded too.
+    http_head_init(&head, 1024);
+    http_head_configure(&head, HTTP_HEAD_LOWERCASE);
+    {
+        http_mark mark;
+        if (!http_head_mark(&head, &mark) ||
+            !http_head_push_field(&mark, "X-SPLIT-", 8) ||
+            !http_head_push_field(&mark, "Name", 4) ||
+            !http_head_push_value(&mark, "Value", 5) ||
+            !http_head_commit(&mark)) {
+            fprintf(stderr, "Partial push failed.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+    if ((strcmp(head.data, "x-split-name") != 0) ||
+        (strcmp(http_head_find(&head, "X-Split-Name"), "Value") != 0)) {
+        fprintf(stderr, "Partial push was not folded.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_kill(&head);
+
+    return (EXIT_SUCCESS);
+}
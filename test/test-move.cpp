@@ -0,0 +1,155 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+/*!
+ * @file
+ * @brief Test moving, swapping and adopting buffers.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <utility>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    // Moving hands over the memory, without copying.
+    ::http_head head;
+    ::http_head_init(&head, 256);
+    ::http_head_push(&head, "Host", "example.com");
+    ::http_head_index(&head);
+    const char * data = head.data;
+    ::http_head other;
+    if (!::http_head_move(&other, &head) || (other.data != data) ||
+        (head.data != 0) || (head.index != 0) || (other.index == 0) ||
+        (std::strcmp(::http_head_find(&other, "host"), "example.com") != 0)) {
+        return (fail("Could not move a buffer."));
+    }
+    ::http_head_kill(&head);
+
+    // Released memory can be adopted again, tombstones included.
+    ::http_head_push(&other, "Accept", "*/*");
+    ::http_head_push(&other, "User-Agent", "Mozilla/5.0");
+    ::http_head_remove(&other, "Host", 4);
+    std::size_t size = 0;
+    std::size_t used = 0;
+    char * buffer = ::http_head_release(&other, &size, &used);
+    if ((buffer != data) || (size != 256) || (other.data != 0)) {
+        return (fail("Could not release a buffer."));
+    }
+    if (::http_head_adopt(&head, buffer, size, used+1, 0, 0) ||
+        ::http_head_adopt(&head, buffer, size, used-1, 0, 0) ||
+        !::http_head_adopt(&head, buffer, size, used, 0, 0) ||
+        (head.dead == 0) || (head.limit != 256) ||
+        (std::strcmp(::http_head_find(&head, "Accept"), "*/*") != 0) ||
+        (std::strcmp(::http_head_find(&head, "Host"), "") != 0)) {
+        return (fail("Could not adopt a buffer."));
+    }
+    ::http_head_kill(&head);
+
+    // Swaps exchange memory, copying headers out of inline memory.
+    http::Head lhs(256);
+    http::SmallHead<128> rhs;
+    lhs.push("Host", "example.com");
+    rhs.push("Accept", "*/*");
+    const char * lhs_data = lhs.backend().data;
+    swap(lhs, rhs);
+    if ((rhs.backend().data != lhs_data) ||
+        (rhs.find("Host") != "example.com") ||
+        (lhs.find("Accept") != "*/*") || (lhs.backend().storage != 0)) {
+        return (fail("Could not swap buffers."));
+    }
+    swap(lhs, rhs);
+
+    // Buffers pass through raw memory and back.
+    std::size_t capacity = 0;
+    std::size_t length = 0;
+    buffer = lhs.release(capacity, length);
+    if ((buffer != lhs_data) || (lhs.release(size, used) != 0) ||
+        (size != 0) || !rhs.adopt(buffer, capacity, length) ||
+        (rhs.find("Host") != "example.com") ||
+        !rhs.find("Accept").empty()) {
+        return (fail("Could not release and adopt."));
+    }
+
+    // Adopted names follow the options of the buffer that adopts them.
+    static const char mixed[] = "X-Foo\0bar\0";
+    buffer = static_cast<char*>(std::malloc(sizeof(mixed)));
+    std::memcpy(buffer, mixed, sizeof(mixed));
+    http::Head lower(64);
+    lower.configure(HTTP_HEAD_LOWERCASE);
+    if (!lower.adopt(buffer, sizeof(mixed), sizeof(mixed)-1) ||
+        (lower.find("x-foo") != "bar") || (lower.find("X-Foo") != "bar") ||
+        (std::strcmp(lower.backend().data, "x-foo") != 0)) {
+        return (fail("Could not adopt into a lowercase buffer."));
+    }
+
+#if defined(CHTTP_CXX11)
+    // Inline memory stays behind when moving, so its headers are copied out.
+    {
+        http::SmallHead<128> small;
+        small.push("Host", "example.com");
+        http::Head moved(std::move(small));
+        if ((moved.backend().data == small.backend().data) ||
+            (moved.find("Host") != "example.com") ||
+            (small.backend().data != 0)) {
+            return (fail("Could not move out of inline memory."));
+        }
+    }
+
+    // Moves hand over memory, clones copy it.
+    http::Head moved(std::move(rhs));
+    if ((moved.backend().data != lhs_data) || (rhs.backend().data != 0)) {
+        return (fail("Could not move a buffer."));
+    }
+    lhs = std::move(moved);
+    if ((lhs.backend().data != lhs_data) || (moved.backend().data != 0)) {
+        return (fail("Could not move-assign a buffer."));
+    }
+    lhs.index();
+    http::Head copy = lhs.clone();
+    if ((copy.backend().data == lhs_data) ||
+        (copy.backend().index == 0) ||
+        (copy.find("Host") != "example.com")) {
+        return (fail("Could not clone a buffer."));
+    }
+    copy.push("Accept", "*/*");
+    if (!lhs.find("Accept").empty()) {
+        return (fail("Clone shares memory."));
+    }
+#endif
+
+    return (EXIT_SUCCESS);
+}
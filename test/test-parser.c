@@ -0,0 +1,126 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that the parser handles headers split across reads.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static const char request[] =
+    "Host: example.com\r\n"
+    "Content-Type:text/plain  \r\n"
+    "X-Empty:\r\n"
+    "X-Padded: \t  lots of   space \t \r\n"
+    "X-Long: 0123456789012345678901234567890123456789012345678901234567\r\n"
+    "Bare: line feed\n"
+    "\r\n"
+    "body";
+
+static int check (const http_head * head)
+{
+    return ((strcmp(http_head_find(head, "host"), "example.com") == 0) &&
+            (strcmp(http_head_find(head, "content-type"), "text/plain") == 0)
+        && (strcmp(http_head_find(head, "x-empty"), "") == 0)
+        && (strcmp(http_head_find(head, "x-padded"), "lots of   space") == 0)
+        && (strlen(http_head_find(head, "x-long")) == 58)
+        && (strcmp(http_head_find(head, "bare"), "line feed") == 0));
+}
+
+static int parse (const char * data, size_t size, size_t step, int headers)
+{
+    http_head head;
+    http_parser parser;
+    http_cursor cursor;
+    size_t used = 0;
+    size_t part = 0;
+    int count = 0;
+
+    http_head_init(&head, 4*1024);
+    http_parser_init(&parser, &head);
+    while ((used < size) && !http_parser_done(&parser)
+           && !http_parser_fail(&parser))
+    {
+        part = (size-used < step)? size-used : step;
+        used += http_parser_feed(&parser, data+used, part);
+    }
+    http_cursor_init(&cursor, &head);
+    while (http_cursor_next(&cursor)) {
+        ++count;
+    }
+    if (http_parser_done(&parser) && (headers == 6) && !check(&head)) {
+        count = -1;
+    }
+    if (!http_parser_done(&parser)) {
+        used = 0;
+    }
+    http_head_kill(&head);
+    return ((count == headers)? (int)used : -1);
+}
+
+static const char * invalid[] = {
+    "Host: example.com\r\n folded\r\n\r\n",
+    "Host : example.com\r\n\r\n",
+    ": example.com\r\n\r\n",
+    "Host example.com\r\n\r\n",
+    "Host: example.com\r\r\n\r\n",
+};
+
+int main(int argc, char ** argv)
+{
+    size_t step;
+    size_t i;
+
+    // Feed the request in chunks of every size, stopping before the body.
+    for (step = 1; step <= sizeof(request); ++step)
+    {
+        if (parse(request, sizeof(request)-1, step, 6)
+            != (int)(sizeof(request)-5))
+        {
+            fprintf(stderr, "Parse failed with %d byte reads.\n", (int)step);
+            return (EXIT_FAILURE);
+        }
+    }
+
+    // Malformed headers are rejected, keeping only the valid ones.
+    for (i = 0; i < sizeof(invalid)/sizeof(invalid[0]); ++i)
+    {
+        for (step = 1; step <= strlen(invalid[i]); ++step)
+        {
+            if (parse(invalid[i], strlen(invalid[i]), step, i==0) != 0)
+            {
+                fprintf(stderr, "Invalid header #%d accepted.\n", (int)i);
+                return (EXIT_FAILURE);
+            }
+        }
+    }
+
+    return (EXIT_SUCCESS);
+}
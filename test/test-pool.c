@@ -0,0 +1,105 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that pooled buffers are recycled.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+int main(int argc, char ** argv)
+{
+    http_head heads[6];
+    const char * data = 0;
+    http_cursor cursor;
+    http_pool pool;
+    int i;
+
+    http_pool_init(&pool, 1024, 4);
+
+    // Acquire more buffers than a single slab holds.
+    for (i = 0; i < 6; ++i)
+    {
+        if (!http_head_pool_acquire(&heads[i], &pool))
+        {
+            fprintf(stderr, "Could not acquire buffer.\n");
+            return (EXIT_FAILURE);
+        }
+        if (!http_head_push(&heads[i], "Host", "example.com"))
+        {
+            fprintf(stderr, "Could not push header.\n");
+            return (EXIT_FAILURE);
+        }
+    }
+
+    // Released buffers are handed out again.
+    data = heads[5].data;
+    http_head_pool_release(&heads[5]);
+    if (!http_head_pool_acquire(&heads[5], &pool) || (heads[5].data != data))
+    {
+        fprintf(stderr, "Buffer was not recycled.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Reset buffers can be filled again.
+    http_head_index(&heads[0]);
+    http_head_reset(&heads[0]);
+    http_cursor_init(&cursor, &heads[0]);
+    if (http_cursor_next(&cursor) ||
+        (strlen(http_head_find(&heads[0], "Host")) != 0))
+    {
+        fprintf(stderr, "Buffer was not reset.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_push(&heads[0], "Content-Length", "0");
+    if (strcmp(http_head_find(&heads[0], "Content-Length"), "0") != 0)
+    {
+        fprintf(stderr, "Header not found after reset.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Slab buffers can't grow past the slab size.
+    data = heads[1].data;
+    if ((pool.allocator.resize(pool.allocator.context,
+                               heads[1].data, heads[1].used+1, 512) != data) ||
+        (pool.allocator.resize(pool.allocator.context,
+                               heads[1].data, heads[1].used+1, 2048) != 0) ||
+        (strcmp(http_head_find(&heads[1], "Host"), "example.com") != 0))
+    {
+        fprintf(stderr, "Pooled buffer was resized.\n");
+        return (EXIT_FAILURE);
+    }
+
+    for (i = 0; i < 6; ++i) {
+        http_head_pool_release(&heads[i]);
+    }
+    http_pool_kill(&pool);
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,188 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test header removal, replacement and compaction.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+// Check headers against "field=value;" pairs, in order.
+static int check (const http_head * head, const char * expected)
+{
+    http_cursor cursor;
+    char actual[256];
+    size_t used = 0;
+    http_cursor_init(&cursor, head);
+    while (http_cursor_next(&cursor)) {
+        used += sprintf(actual+used, "%s=%s;", cursor.field, cursor.value);
+    }
+    actual[used] = '\0';
+    if (strcmp(actual, expected) != 0) {
+        fprintf(stderr, "Got '%s'.\n", actual);
+        return 0;
+    }
+    return 1;
+}
+
+// Always move the buffer when it grows, scribbling over the old one.
+static void * acquire (void * context, size_t size)
+{
+    return (malloc(size));
+}
+
+static void * resize (void * context, void * data, size_t used, size_t size)
+{
+    void * copy = malloc(size);
+    if (copy != 0) {
+        memcpy(copy, data, used);
+        memset(data, '#', used);
+        free(data);
+    }
+    return (copy);
+}
+
+static void release (void * context, void * data, size_t size)
+{
+    free(data);
+}
+
+static const http_allocator moving = { acquire, resize, release, 0 };
+
+static int edit (unsigned int options, int index)
+{
+    http_head head;
+    int status = 1;
+    http_head_init(&head, 256);
+    http_head_configure(&head, options);
+    if (index) {
+        http_head_index(&head);
+    }
+    http_head_push(&head, "Connection", "keep-alive, X-Hop");
+    http_head_push(&head, "Host", "example.com");
+    http_head_push(&head, "X-Hop", "1");
+    http_head_push(&head, "Connection", "close");
+    http_head_push(&head, "Accept", "*/*");
+
+    // Removal keeps the order of other headers.
+    status = status && (http_head_remove(&head, "connection", 10) == 2) &&
+        (http_head_remove(&head, "Missing", 7) == 0) &&
+        (strcmp(http_head_find(&head, "Connection"), "") == 0) &&
+        (strcmp(http_head_find(&head, "Accept"), "*/*") == 0) &&
+        check(&head, "Host=example.com;X-Hop=1;Accept=*/*;");
+
+    // Same size and much shorter data are written in place, keeping the
+    // order.
+    status = status &&
+        http_head_replace(&head, "host", 4, "example.org", 11) &&
+        http_head_replace(&head, "X-Hop", 5, "2", 1) &&
+        http_head_replace(&head, "accept", 6, "", 0) &&
+        (strcmp(http_head_find(&head, "Host"), "example.org") == 0) &&
+        check(&head, "Host=example.org;X-Hop=2;Accept=;");
+
+    // Longer data (and slightly shorter data) moves the header.
+    status = status &&
+        http_head_replace(&head, "Host", 4, "www.example.org", 15) &&
+        http_head_replace(&head, "Host", 4, "www.example.o", 13) &&
+        (strcmp(http_head_find(&head, "host"), "www.example.o") == 0) &&
+        check(&head, "X-Hop=2;Accept=;Host=www.example.o;");
+
+    // Missing headers are appended, duplicates removed.
+    http_head_push(&head, "Via", "a");
+    http_head_push(&head, "Via", "b");
+    status = status &&
+        http_head_replace(&head, "Date", 4, "today", 5) &&
+        http_head_replace(&head, "via", 3, "c", 1) &&
+        check(&head, "X-Hop=2;Accept=;Host=www.example.o;Via=c;Date=today;");
+
+    // Compaction keeps the headers.
+    http_head_compact(&head);
+    status = status &&
+        check(&head, "X-Hop=2;Accept=;Host=www.example.o;Via=c;Date=today;") &&
+        (strcmp(http_head_find(&head, "date"), "today") == 0) &&
+        (strcmp(http_head_find(&head, "via"), "c") == 0);
+    http_head_kill(&head);
+    return (status);
+}
+
+int main(int argc, char ** argv)
+{
+    http_head head;
+    char value[96];
+    char expected[128];
+    int i = 0;
+
+    if (!edit(0, 0) || !edit(HTTP_HEAD_TOKENS, 0) ||
+        !edit(HTTP_HEAD_TOKENS, 1)) {
+        fprintf(stderr, "Edits failed.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Repeated edits in a small, fixed buffer only fit if dead space is
+    // reclaimed.
+    memset(value, 'x', sizeof(value));
+    http_head_init(&head, 128);
+    http_head_index(&head);
+    http_head_push(&head, "Host", "example.com");
+    for (i = 0; i < 1000; ++i)
+    {
+        if (!http_head_replace(&head, "X-Value", 7, value, 1 + i%60) ||
+            (strlen(http_head_find(&head, "x-value")) != (size_t)(1 + i%60))) {
+            fprintf(stderr, "Replace #%d failed.\n", i);
+            return (EXIT_FAILURE);
+        }
+    }
+    sprintf(expected, "Host=example.com;X-Value=%.40s;", value);
+    if (!check(&head, expected)) {
+        fprintf(stderr, "Headers lost after replacements.\n");
+        return (EXIT_FAILURE);
+    }
+    // Data that can't fit leaves the buffer unchanged.
+    if (http_head_replace(&head, "Host", 4, value, sizeof(value)) ||
+        !check(&head, expected)) {
+        fprintf(stderr, "Replace overflow.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_kill(&head);
+
+    // Replacing still works when a failed push already moved the buffer.
+    memset(value, 'y', sizeof(value));
+    http_head_init_ex(&head, 32, 64, &moving);
+    http_head_push(&head, "X-Long-Header-Name-0123", "ab");
+    sprintf(expected, "X-Long-Header-Name-0123=%.30s;", value);
+    if (!http_head_replace(&head, "X-Long-Header-Name-0123", 23, value, 30) ||
+        !check(&head, expected)) {
+        fprintf(stderr, "Replace after growth failed.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_kill(&head);
+
+    return (EXIT_SUCCESS);
+}
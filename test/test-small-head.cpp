@@ -0,0 +1,137 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test buffers that start out in caller-provided memory.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    // Count live allocations.
+    int live = 0;
+
+    void * acquire (void * context, std::size_t size)
+    {
+        ++live;
+        return (std::malloc(size));
+    }
+
+    void * resize (void * context, void * data,
+                   std::size_t used, std::size_t size)
+    {
+        return (std::realloc(data, size));
+    }
+
+    void release (void * context, void * data, std::size_t size)
+    {
+        --live;
+        std::free(data);
+    }
+
+    const ::http_allocator counting = { acquire, resize, release, 0 };
+
+}
+
+int main (int argc, char ** argv)
+{
+    // Small headers stay in place.
+    char storage[64];
+    ::http_head head;
+    if (::http_head_init_storage(&head, storage, 0, 1024, &counting) ||
+        !::http_head_init_storage(&head, storage, sizeof(storage), 1024,
+                                  &counting)) {
+        return (fail("Could not use storage."));
+    }
+    ::http_head_push(&head, "Host", "example.com");
+    ::http_head_push(&head, "Accept", "*/*");
+    if ((head.data != storage) || (live != 0) ||
+        (std::strcmp(::http_head_find(&head, "Host"), "example.com") != 0)) {
+        return (fail("Small headers left storage."));
+    }
+    // Larger ones move to the heap, keeping what was pushed so far.
+    ::http_head_push(&head, "User-Agent",
+                     "Mozilla/5.0 (X11; Linux x86_64; rv:120.0) Firefox/120");
+    if ((head.data == storage) || (live != 1) || (head.size > 1024) ||
+        (std::strcmp(::http_head_find(&head, "Accept"), "*/*") != 0) ||
+        (std::strcmp(::http_head_find(&head, "user-agent"),
+            "Mozilla/5.0 (X11; Linux x86_64; rv:120.0) Firefox/120") != 0)) {
+        return (fail("Could not grow out of storage."));
+    }
+    ::http_head_kill(&head);
+    if (live != 0) {
+        return (fail("Heap memory leaked."));
+    }
+
+    // Storage can also have a fixed capacity.
+    ::http_head_init_storage(&head, storage, sizeof(storage), 0, &counting);
+    ::http_head_push(&head, "Host", "example.com");
+    if (::http_head_push(&head, "User-Agent",
+            "Mozilla/5.0 (X11; Linux x86_64; rv:120.0) Firefox/120") ||
+        (head.data != storage) || (live != 0) ||
+        (std::strcmp(::http_head_find(&head, "Host"), "example.com") != 0)) {
+        return (fail("Fixed storage overflowed."));
+    }
+    ::http_head_kill(&head);
+
+    // The C++ wrapper keeps the storage inline.
+    {
+        http::SmallHead<64> small(4*1024, &counting);
+        http::Head& base = small;
+        base.push("Host", "example.com");
+        if ((live != 0) ||
+            (small.backend().data < reinterpret_cast<char*>(&small)) ||
+            (small.backend().data >= reinterpret_cast<char*>(&small + 1))) {
+            return (fail("SmallHead allocated."));
+        }
+        base.push("X-Padding", std::string(100, 'x'));
+        if ((live != 1) || (base.find("Host") != "example.com") ||
+            (base.find("X-Padding").size() != 100)) {
+            return (fail("SmallHead could not grow."));
+        }
+    }
+    if (live != 0) {
+        return (fail("SmallHead leaked."));
+    }
+    http::SmallHead<32> fixed;
+    if (!fixed.push("Host", "example.com") ||
+        fixed.push("X-Padding", std::string(100, 'x'))) {
+        return (fail("Fixed SmallHead overflowed."));
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,136 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test freezing headers into shared snapshots.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+    std::string dump (const ::http_head& head)
+    {
+        std::string text;
+        ::http_cursor cursor;
+        ::http_cursor_init(&cursor, &head);
+        while (::http_cursor_next(&cursor)) {
+            text.append(cursor.field, cursor.field_size).append(": ");
+            text.append(cursor.value, cursor.value_size).append("\n");
+        }
+        return (text);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    http::Head head(1024);
+    head.configure(HTTP_HEAD_TOKENS);
+    head.push("Host", "example.com");
+    head.push("X-Removed", "gone");
+    head.push("Via", "a");
+    head.push("X-Custom", "1");
+    head.push("Via", "b");
+    head.remove("x-removed");
+
+    // Snapshots skip removed headers, and come with an index.
+    http::Snapshot snapshot = head.freeze();
+    const std::string expected =
+        "Host: example.com\nVia: a\nX-Custom: 1\nVia: b\n";
+    if ((dump(snapshot.backend()) != expected) ||
+        (snapshot.backend().dead != 0) || (snapshot.backend().index == 0)) {
+        return (fail("Snapshot doesn't match."));
+    }
+    if ((snapshot.find("HOST") != "example.com") ||
+        (snapshot.find(HTTP_HEADER_VIA) != "a") ||
+        (snapshot.find(http::View("x-custom")) != "1") ||
+        (snapshot.find("X-Removed") != "") ||
+        (snapshot.find_all("via").join() != "a, b")) {
+        return (fail("Snapshot lookup failed."));
+    }
+    http::Cursor cursor(snapshot);
+    if (!cursor.find("Via") || !cursor.find("Via") ||
+        (cursor.value_view() != "b") || cursor.find("Via")) {
+        return (fail("Snapshot cursor failed."));
+    }
+
+    // Later changes don't show through.
+    head.replace("Host", "example.org");
+    head.push("X-Late", "1");
+    if ((snapshot.find("Host") != "example.com") ||
+        (snapshot.find("X-Late") != "")) {
+        return (fail("Snapshot changed with its source."));
+    }
+
+    // Snapshots can't grow.
+    ::http_head& frozen = const_cast< ::http_head& >(snapshot.backend());
+    if (::http_head_push(&frozen, "X-Illegal", "1") != 0) {
+        return (fail("Pushed into a snapshot."));
+    }
+
+    // Copies share the same headers.
+    http::Snapshot copy(snapshot);
+    http::Snapshot other(http::Head(64));
+    other = copy;
+    other = other;
+    if ((&copy.backend() != &snapshot.backend()) ||
+        (&other.backend() != &snapshot.backend())) {
+        return (fail("Copies don't share headers."));
+    }
+
+    // Empty heads freeze too.
+    http::Head empty(64);
+    http::Snapshot nothing(empty);
+    if ((dump(nothing.backend()) != "") || (nothing.find("Host") != "")) {
+        return (fail("Empty snapshot doesn't match."));
+    }
+
+    // The C API counts references.
+    ::http_snapshot * shared = ::http_head_freeze(&head.backend());
+    if ((shared == 0) || (::http_snapshot_retain(shared) != shared)) {
+        return (fail("Could not retain snapshot."));
+    }
+    ::http_snapshot_release(shared);
+    if (std::strcmp(::http_head_find(::http_snapshot_head(shared), "Host"),
+                    "example.org") != 0) {
+        return (fail("Released snapshot too early."));
+    }
+    ::http_snapshot_release(shared);
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,113 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test instrumentation counters and hooks.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int overflows = 0;
+static int rejects = 0;
+
+static void observe (void * context, const http_head * head,
+                     http_stats_event event)
+{
+    if (context != &overflows) {
+        return;
+    }
+    if (event == HTTP_STATS_OVERFLOW) {
+        ++overflows;
+    }
+    if (event == HTTP_STATS_REJECT) {
+        ++rejects;
+    }
+}
+
+int main(int argc, char ** argv)
+{
+    http_head head;
+    http_mark mark;
+    http_stats stats;
+    int enabled = 0;
+
+    http_stats_reset();
+    http_stats_observe(observe, &overflows);
+    http_head_init(&head, 64);
+    http_head_push(&head, "Host", "example.com");
+    http_head_push(&head, "Via", "a");
+    http_head_find(&head, "via");
+    http_head_find(&head, "X-Missing");
+    http_head_find_id(&head, HTTP_HEADER_HOST);
+    // Empty names are rejected, long values don't fit.  Both pushes copy
+    // their name before failing, then get cancelled.
+    http_head_push(&head, "", "1");
+    http_head_push(&head, "X-Long",
+                   "0123456789012345678901234567890123456789");
+    // Cancel a header half way.
+    http_head_mark(&head, &mark);
+    http_head_push_field(&mark, "X-Partial", 9);
+    http_head_cancel(&mark);
+    enabled = http_stats_read(&stats);
+    http_head_kill(&head);
+    http_stats_observe(0, 0);
+
+    // Without counting, everything stays at zero.
+    if (!enabled)
+    {
+        static const http_stats zero;
+        if ((memcmp(&stats, &zero, sizeof(zero)) != 0) ||
+            (overflows != 0) || (rejects != 0)) {
+            fprintf(stderr, "Counters should be disabled.\n");
+            return (EXIT_FAILURE);
+        }
+        return (EXIT_SUCCESS);
+    }
+    if ((stats.commits != 2) || (stats.cancels != 3) ||
+        (stats.pushes != 7) || (stats.bytes != 4+11+3+1+0+6+9) ||
+        (stats.hits != 2) || (stats.misses != 1) || (stats.probes != 5) ||
+        (stats.overflows != 1) || (stats.rejects != 1) ||
+        (stats.peak_used != 23) || (stats.peak_fill != 23*1000/64)) {
+        fprintf(stderr, "Counters don't match.\n");
+        return (EXIT_FAILURE);
+    }
+    if ((overflows != 1) || (rejects != 1)) {
+        fprintf(stderr, "Hook was not called.\n");
+        return (EXIT_FAILURE);
+    }
+    http_stats_reset();
+    http_stats_read(&stats);
+    if ((stats.commits != 0) || (stats.peak_used != 0)) {
+        fprintf(stderr, "Reset failed.\n");
+        return (EXIT_FAILURE);
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,131 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test that well-known header names are stored as tokens.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+static int check (const http_head * head)
+{
+    http_cursor cursor;
+    http_cursor_init(&cursor, head);
+    // Iteration exposes canonical names.
+    if (!http_cursor_next(&cursor) ||
+        (strcmp(cursor.field, "Content-Length") != 0) ||
+        (cursor.field_size != 14) || (strcmp(cursor.value, "123") != 0)) {
+        return 0;
+    }
+    if (!http_cursor_next(&cursor) ||
+        (strcmp(cursor.field, "X-Custom") != 0) ||
+        (strcmp(cursor.value, "abc") != 0)) {
+        return 0;
+    }
+    if (!http_cursor_next(&cursor) ||
+        (strcmp(cursor.field, "Host") != 0) ||
+        (strcmp(cursor.value, "example.com") != 0)) {
+        return 0;
+    }
+    if (http_cursor_next(&cursor)) {
+        return 0;
+    }
+    // Lookups work by name and by identifier.
+    return ((strcmp(http_head_find(head, "CONTENT-length"), "123") == 0) &&
+            (strcmp(http_head_find(head, "x-custom"), "abc") == 0) &&
+            (strcmp(http_head_find(head, "host"), "example.com") == 0) &&
+            (strcmp(http_head_find_id(head, HTTP_HEADER_CONTENT_LENGTH),
+                    "123") == 0) &&
+            (strcmp(http_head_find_id(head, HTTP_HEADER_HOST),
+                    "example.com") == 0) &&
+            (strlen(http_head_find_id(head, HTTP_HEADER_DATE)) == 0) &&
+            (strlen(http_head_find(head, "Date")) == 0));
+}
+
+int main(int argc, char ** argv)
+{
+    http_mark mark;
+    int i;
+
+    http_head head;
+    http_head_init(&head, 4*1024);
+    http_head_configure(&head, HTTP_HEAD_TOKENS);
+
+    // All well-known names round-trip through the perfect hash.
+    for (i = HTTP_HEADER_UNKNOWN+1; i < HTTP_HEADER_COUNT; ++i)
+    {
+        const char * name = http_header_name((http_header)i);
+        if (http_header_id(name, strlen(name)) != (http_header)i)
+        {
+            fprintf(stderr, "Bad perfect hash for '%s'.\n", name);
+            return (EXIT_FAILURE);
+        }
+    }
+    if (http_header_id("Content-Lenght", 14) != HTTP_HEADER_UNKNOWN)
+    {
+        fprintf(stderr, "Unknown header matched.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Push well-known names, including a partial push.
+    http_head_push(&head, "content-length", "123");
+    http_head_push(&head, "X-Custom", "abc");
+    http_head_mark(&head, &mark);
+    http_head_push_field(&mark, "Ho", 2);
+    http_head_push_field(&mark, "st", 2);
+    http_head_push_value(&mark, "example.com", 11);
+    http_head_commit(&mark);
+    if (head.used != 3+4+9+4+3+12)
+    {
+        fprintf(stderr, "Names not stored as tokens.\n");
+        return (EXIT_FAILURE);
+    }
+    if (!check(&head))
+    {
+        fprintf(stderr, "Headers don't match.\n");
+        return (EXIT_FAILURE);
+    }
+    http_head_index(&head);
+    if (!check(&head))
+    {
+        fprintf(stderr, "Indexed headers don't match.\n");
+        return (EXIT_FAILURE);
+    }
+
+    // Names can't be confused with tokens.
+    if (http_head_push(&head, "\001\003", "x"))
+    {
+        fprintf(stderr, "Reserved name accepted.\n");
+        return (EXIT_FAILURE);
+    }
+
+    http_head_kill(&head);
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,161 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test typed accessors and their cache.
+ */
+
+#include <chttp.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <string.h>
+
+#define FIELD(name) name, sizeof(name)-1
+
+// "Sun, 06 Nov 1994 08:49:37 GMT", in seconds since the epoch.
+static const time_t example = 784111777;
+
+static int check_u64 (http_head * head, const char * field,
+                      int status, unsigned long long expected)
+{
+    unsigned long long value = 7;
+    if (http_head_get_u64(head, field, strlen(field), &value) != status) {
+        return 0;
+    }
+    return (value == ((status > 0)? expected : 7));
+}
+
+static int check_date (const char * data, int status, time_t expected)
+{
+    http_head head;
+    time_t value = 0;
+    int pass = 0;
+    http_head_init(&head, 256);
+    http_head_push(&head, "Date", data);
+    // Second pass hits the cache.
+    for (pass = 0; pass < 2; ++pass)
+    {
+        if ((http_head_get_date(&head, FIELD("date"), &value) != status) ||
+            ((status > 0) && (value != expected))) {
+            fprintf(stderr, "Date \"%s\" failed in pass #%d.\n", data, pass);
+            return 0;
+        }
+    }
+    http_head_kill(&head);
+    return 1;
+}
+
+int main(int argc, char ** argv)
+{
+    http_head head;
+    int pass = 0;
+
+    for (pass = 0; pass < 2; ++pass)
+    {
+        http_head_init(&head, 1024);
+        if (pass > 0) {
+            http_head_configure(&head, HTTP_HEAD_TOKENS);
+            http_head_index(&head);
+        }
+        http_head_push(&head, "Content-Length", "42");
+        http_head_push(&head, "Max-Forwards", "18446744073709551615");
+        http_head_push(&head, "X-Overflow", "18446744073709551616");
+        http_head_push(&head, "X-Sign", "-1");
+        http_head_push(&head, "X-Empty", "");
+        http_head_push(&head, "X-List", "42, 42");
+        // Ask twice to go through the cache.
+        if (!check_u64(&head, "content-length", 1, 42) ||
+            !check_u64(&head, "CONTENT-LENGTH", 1, 42) ||
+            !check_u64(&head, "Max-Forwards", 1, 18446744073709551615ull) ||
+            !check_u64(&head, "X-Overflow", -1, 0) ||
+            !check_u64(&head, "X-Sign", -1, 0) ||
+            !check_u64(&head, "X-Empty", -1, 0) ||
+            !check_u64(&head, "X-List", -1, 0) ||
+            !check_u64(&head, "X-Missing", 0, 0) ||
+            !check_u64(&head, "X-Missing", 0, 0) ||
+            !check_u64(&head, "X-List", -1, 0)) {
+            fprintf(stderr, "Numbers failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        // Names too long for the cache still work.
+        http_head_push(&head, "X-A-Header-Name-Longer-Than-The-Cache", "1");
+        if (!check_u64(&head, "X-A-Header-Name-Longer-Than-The-Cache", 1, 1) ||
+            !check_u64(&head, "X-A-Header-Name-Longer-Than-The-Cache", 1, 1)) {
+            fprintf(stderr, "Long names failed in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        // Edits drop cached results.
+        http_head_push(&head, "X-Missing", "5");
+        if (!check_u64(&head, "X-Missing", 1, 5)) {
+            fprintf(stderr, "Push did not drop cache in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_replace(&head, FIELD("Content-Length"), FIELD("1"));
+        if (!check_u64(&head, "Content-Length", 1, 1)) {
+            fprintf(stderr, "Replace did not drop cache in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_replace(&head, FIELD("Content-Length"), FIELD("123456"));
+        if (!check_u64(&head, "Content-Length", 1, 123456)) {
+            fprintf(stderr, "Replace did not drop cache in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_remove(&head, FIELD("content-length"));
+        if (!check_u64(&head, "Content-Length", 0, 0)) {
+            fprintf(stderr, "Remove did not drop cache in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_reset(&head);
+        if (!check_u64(&head, "Max-Forwards", 0, 0)) {
+            fprintf(stderr, "Reset did not drop cache in pass #%d.\n", pass);
+            return (EXIT_FAILURE);
+        }
+        http_head_kill(&head);
+    }
+
+    // All three formats from RFC 9110.
+    if (!check_date("Sun, 06 Nov 1994 08:49:37 GMT", 1, example) ||
+        !check_date("Sunday, 06-Nov-94 08:49:37 GMT", 1, example) ||
+        !check_date("Sun Nov  6 08:49:37 1994", 1, example) ||
+        !check_date("Thu, 01 Jan 1970 00:00:00 GMT", 1, 0) ||
+        !check_date("Tue, 29 Feb 2000 23:59:59 GMT", 1, 951868799) ||
+        !check_date("Sat, 31 Feb 2024 08:49:37 GMT", -1, 0) ||
+        !check_date("Fri, 29 Feb 2019 08:49:37 GMT", -1, 0) ||
+        !check_date("Thu, 29 Feb 1900 08:49:37 GMT", -1, 0) ||
+        !check_date("Sunday, 31-Apr-94 08:49:37 GMT", -1, 0) ||
+        !check_date("Thu Feb 29 08:49:37 2024", 1, 1709196577) ||
+        !check_date("Sun, 06 Nov 1994 08:49:37 UTC", -1, 0) ||
+        !check_date("Sun, 06 Nov 1994 24:49:37 GMT", -1, 0) ||
+        !check_date("Sun, 06 Now 1994 08:49:37 GMT", -1, 0) ||
+        !check_date("Sun, 6 Nov 1994 08:49:37 GMT", -1, 0) ||
+        !check_date("yesterday", -1, 0) ||
+        !check_date("", -1, 0)) {
+        return (EXIT_FAILURE);
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,80 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test the C++ range over values of a repeated header.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <iostream>
+#include <string>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    http::Head head(4*1024);
+    head.push("X-Forwarded-For", "203.0.113.195");
+    head.push("Host", "example.com");
+    head.push("X-Forwarded-For", "198.51.100.17");
+
+    std::string values;
+    http::Values range = head.find_all("x-forwarded-for");
+    for (http::Values::iterator i = range.begin(); i != range.end(); ++i) {
+        values += std::string(*i) + ";";
+    }
+    if (values != "203.0.113.195;198.51.100.17;") {
+        return (fail("Iteration doesn't match."));
+    }
+    if (range.join() != "203.0.113.195, 198.51.100.17") {
+        return (fail("Join doesn't match."));
+    }
+    if (!head.find_all("Missing").empty() ||
+        (head.find_all("Missing").join() != "") ||
+        head.find_all("Host").empty()) {
+        return (fail("Empty check failed."));
+    }
+
+    // Resume from the cursor's position.
+    http::Cursor cursor(head);
+    if (!cursor.find("Host") || !cursor.find("X-Forwarded-For") ||
+        (cursor.value_view() != "198.51.100.17") ||
+        cursor.find("X-Forwarded-For")) {
+        return (fail("Cursor lookup failed."));
+    }
+
+    return (EXIT_SUCCESS);
+}
@@ -0,0 +1,104 @@
+// Copyright (c) 2012, Andre Caron (andre.l.caron@gmail.com)
+// All rights reserved.
+//
+// Redistribution and use in source and binary forms, with or without
+// modification, are permitted provided that the following conditions are met:
+//
+//  * Redistributions of source code must retain the above copyright notice,
+//    this list of conditions and the following disclaimer.
+//
+//  * Redistributions in binary form must reproduce the above copyright notice,
+//    this list of conditions and the following disclaimer in the documentation
+//    and/or other materials provided with the distribution.
+//
+// THIS SOFTWARE IS PROVIDED BY THE COPYRIGHT HOLDERS AND CONTRIBUTORS "AS IS"
+// AND ANY EXPRESS OR IMPLIED WARRANTIES, INCLUDING, BUT NOT LIMITED TO, THE
+// IMPLIED WARRANTIES OF MERCHANTABILITY AND FITNESS FOR A PARTICULAR PURPOSE
+// ARE DISCLAIMED.  IN NO EVENT SHALL THE COPYRIGHT HOLDER OR CONTRIBUTORS BE
+// LIABLE FOR ANY DIRECT, INDIRECT, INCIDENTAL, SPECIAL, EXEMPLARY, OR
+// CONSEQUENTIAL DAMAGES (INCLUDING, BUT NOT LIMITED TO, PROCUREMENT OF
+// SUBSTITUTE GOODS OR SERVICES; LOSS OF USE, DATA, OR PROFITS; OR BUSINESS
+// INTERRUPTION) HOWEVER CAUSED AND ON ANY THEORY OF LIABILITY, WHETHER IN
+// CONTRACT, STRICT LIABILITY, OR TORT (INCLUDING NEGLIGENCE OR OTHERWISE)
+// ARISING IN ANY WAY OUT OF THE USE OF THIS SOFTWARE, EVEN IF ADVISED OF THE
+// POSSIBILITY OF SUCH DAMAGE.
+
+
+/*!
+ * @file
+ * @brief Test the allocation-free C++ accessors.
+ */
+
+#include <chttp.hpp>
+#include <cstdlib>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+
+namespace {
+
+    int fail (const char * message)
+    {
+        std::cerr << message << std::endl;
+        return (EXIT_FAILURE);
+    }
+
+}
+
+int main (int argc, char ** argv)
+{
+    // Data as it would sit in a receive buffer.
+    const char wire[] = "Content-Type: text/plain\r\n";
+
+    http::Head head(4*1024);
+    if (!head.push("Content-Length", "123") ||
+        !head.push(http::View(wire, 12), http::View(wire+14, 10)) ||
+        !head.push(std::string("Host"), std::string("example.com")))
+    {
+        return (fail("Could not push headers."));
+    }
+
+    // Look up by literal, by substring and by string.
+    if (head.find("content-length") != "123") {
+        return (fail("Literal lookup failed."));
+    }
+    if (head.find(http::View(wire, 12)) != "text/plain") {
+        return (fail("Substring lookup failed."));
+    }
+    if (head.find(http::View(wire, 11)) != "") {
+        return (fail("Prefix lookup matched."));
+    }
+    if (head.find(std::string("Host")) != "example.com") {
+        return (fail("String lookup failed."));
+    }
+    std::string copy = head.find("Host");
+    if (copy != "example.com") {
+        return (fail("View conversion failed."));
+    }
+#if defined(CHTTP_STRING_VIEW)
+    std::string_view view = head.find("Host");
+    if (view != "example.com") {
+        return (fail("Standard view conversion failed."));
+    }
+#endif
+
+    // Iterate using views.
+    std::ostringstream stream;
+    http::Cursor cursor(head);
+    while (cursor.next())
+    {
+        stream << cursor.field_view() << "=" << cursor.value_view() << ";";
+        if ((cursor.field_view() != cursor.field()) ||
+            (cursor.value_view() != cursor.value()))
+        {
+            return (fail("Views don't match copies."));
+        }
+    }
+    if (stream.str() !=
+        "Content-Length=123;Content-Type=text/plain;Host=example.com;")
+    {
+        return (fail("Iteration doesn't match."));
+    }
+
+    return (EXIT_SUCCESS);
+}